@@ -0,0 +1,205 @@
+/*
+ *   File: backoff.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: state of the contention-adaptive backoff (DO_PAUSE_TYPE 2)
+ *   backoff.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _BACKOFF_H_
+#define _BACKOFF_H_
+
+/*
+ * Every thread keeps a moving average of the retries (DO_PAUSE calls) of its
+ * recent operations. The pause window of a retry starts from the cost of a
+ * cache-line transfer (backoff unit), is scaled by the recent retry rate of
+ * the thread, and doubles with every retry of the current operation (see
+ * do_pause_adaptive in utils.h). Threads that rarely fail thus wait for about
+ * one transfer, while threads that keep failing on a hot lock back off
+ * further, and the window follows the load as it changes.
+ *
+ * The backoff unit is measured once, by BACKOFF_INIT() at the start of the
+ * main of the tests of the structures that back off (before the threads are
+ * pinned), with a ping-pong between two threads on a shared cache line.
+ * ASCYLIB_BACKOFF_UNIT=<cycles> overrides it. Without the adaptive backoff
+ * (BACKOFF=fixed|exp), BACKOFF_INIT() does nothing. The pauses and their
+ * cycles are only counted with STATS=1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sched.h>
+#include <pthread.h>
+#include "getticks.h"
+
+#ifndef DO_PAUSE_TYPE
+#  define DO_PAUSE_TYPE 2	/* 0: fixed max pause, 1: exponential, 2: adaptive */
+#endif
+
+#define BACKOFF_ENV            "ASCYLIB_BACKOFF_UNIT"
+#define BACKOFF_UNIT_DEFAULT   256
+#define BACKOFF_UNIT_MIN       32
+#define BACKOFF_UNIT_MAX       2048
+#define BACKOFF_AVG_SHIFT      3 /* weight of the last operation: 1/8 */
+#define BACKOFF_AVG_ONE        16 /* the average is kept in 1/16 of a retry */
+#define BACKOFF_CALIBRATE_REPS 2000
+
+typedef struct backoff
+{
+  uint32_t retries;		/* retries of the current operation */
+  uint32_t avg;			/* moving average of retries per op (x BACKOFF_AVG_ONE) */
+  size_t pauses;
+  size_t cycles;
+} backoff_t;
+
+extern __thread backoff_t __backoff;
+extern uint32_t __backoff_unit;
+
+/* called at the beginning of every operation (NUM_RETRIES) */
+static inline size_t
+backoff_op_start()
+{
+  backoff_t* b = &__backoff;
+  b->avg += ((b->retries * BACKOFF_AVG_ONE) >> BACKOFF_AVG_SHIFT) - (b->avg >> BACKOFF_AVG_SHIFT);
+  b->retries = 0;
+  return 0;
+}
+
+typedef struct backoff_line
+{
+  volatile uint64_t turn;
+  uint8_t padding[64 - sizeof(uint64_t)];
+} backoff_line_t;
+
+static inline void*
+backoff_calibrate_peer(void* arg)
+{
+  backoff_line_t* l = (backoff_line_t*) arg;
+  uint64_t i;
+  for (i = 1; i < 2 * BACKOFF_CALIBRATE_REPS; i += 2)
+    {
+      while (l->turn != i)
+	{
+	  if (l->turn == UINT64_MAX)
+	    {
+	      return NULL;
+	    }
+	}
+      l->turn = i + 1;
+    }
+  return NULL;
+}
+
+/*
+ * one-way cache-line transfer latency, from BACKOFF_CALIBRATE_REPS round
+ * trips with a thread on another cpu (the default unit if this fails or
+ * takes too long, e.g., on a single cpu)
+ */
+static inline uint32_t
+backoff_calibrate()
+{
+  const char* env = getenv(BACKOFF_ENV);
+  if (env != NULL && *env)
+    {
+      return (uint32_t) atoi(env);
+    }
+
+  static backoff_line_t line __attribute__ ((aligned (64)));
+  line.turn = 0;
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+#if defined(__linux__)
+  cpu_set_t allowed;
+  int cpu = sched_getcpu(), c;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) < 2)
+    {
+      pthread_attr_destroy(&attr);
+      return BACKOFF_UNIT_DEFAULT;
+    }
+  if (cpu >= 0 && CPU_ISSET(cpu, &allowed))
+    {
+      CPU_CLR(cpu, &allowed);
+      for (c = 0; c < CPU_SETSIZE && !CPU_ISSET(c, &allowed); c++);
+      cpu_set_t peer;
+      CPU_ZERO(&peer);
+      CPU_SET(c, &peer);
+      pthread_attr_setaffinity_np(&attr, sizeof(peer), &peer);
+    }
+#endif
+
+  pthread_t peer;
+  if (pthread_create(&peer, &attr, backoff_calibrate_peer, &line) != 0)
+    {
+      pthread_attr_destroy(&attr);
+      return BACKOFF_UNIT_DEFAULT;
+    }
+  pthread_attr_destroy(&attr);
+
+  const ticks limit = (ticks) BACKOFF_CALIBRATE_REPS * BACKOFF_UNIT_MAX * 4;
+  ticks start = getticks(), now = start;
+  uint64_t i;
+  for (i = 0; i < 2 * BACKOFF_CALIBRATE_REPS; i += 2)
+    {
+      line.turn = i + 1;
+      while (line.turn != i + 2 && (now = getticks()) - start < limit);
+      if (line.turn != i + 2)
+	{
+	  break;
+	}
+    }
+  now = getticks();
+  int done = (i == 2 * BACKOFF_CALIBRATE_REPS);
+  line.turn = UINT64_MAX;
+  pthread_join(peer, NULL);
+
+  if (!done)
+    {
+      return BACKOFF_UNIT_DEFAULT;
+    }
+  uint64_t unit = (now - start) / (2 * BACKOFF_CALIBRATE_REPS);
+  if (unit < BACKOFF_UNIT_MIN)
+    {
+      unit = BACKOFF_UNIT_MIN;
+    }
+  else if (unit > BACKOFF_UNIT_MAX)
+    {
+      unit = BACKOFF_UNIT_MAX;
+    }
+  return (uint32_t) unit;
+}
+
+static inline void
+backoff_stats_print(size_t pauses, size_t cycles, size_t updates)
+{
+  printf("#backoff:      unit %u cycles | pauses %-10zu %.3f per update | avg pause %.0f cycles\n",
+	 __backoff_unit, pauses, updates ? (double) pauses / updates : 0.0,
+	 pauses ? (double) cycles / pauses : 0.0);
+}
+
+#if DO_PAUSE_TYPE == 2
+#  define BACKOFF_INIT()          __backoff_unit = backoff_calibrate()
+#else
+#  define BACKOFF_INIT()
+#endif
+
+#define BACKOFF_VARS_DEFINITION()					\
+  __thread backoff_t __backoff;						\
+  uint32_t __backoff_unit = BACKOFF_UNIT_DEFAULT
+
+#endif	/* _BACKOFF_H_ */
@@ -0,0 +1,266 @@
+/*
+ *   File: delegation.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: delegation (server threads) mode of the tests of the
+ *                global-lock data structures
+ *   delegation.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _DELEGATION_H_
+#define _DELEGATION_H_
+
+/*
+ * With -D <n> (delegates), n server threads (on the cores after the ones of
+ * the -n clients) own the data structure, in the spirit of ffwd: the
+ * operations of the clients are executed by the servers, so the nodes and
+ * the lock of the structure stay in the caches of the servers.
+ *
+ * Every client has a request line (written only by the client) and a
+ * response line (written only by its server). A client writes the
+ * operation and bumps the seq of its request; the server that scans the
+ * client (client % n) executes the operation, writes the result and then
+ * copies seq to the response. Thus, every operation moves two cache lines,
+ * whatever the structure does. With n > 1, the servers still synchronize
+ * with each other with the lock of the structure.
+ *
+ * The DS_* macros of a test wrap the direct calls (DS_*_LOCAL) with DLG,
+ * and the test gives dlg_start an exec function that maps the DLG_OP_*
+ * operations to the DS_*_LOCAL calls.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <malloc.h>
+#include <sched.h>
+#include "common.h"
+#include "atomic_ops_if.h"
+
+/* spins of a waiting client (idle scans of a server) before yielding the core */
+#ifndef DLG_SPIN_YIELD
+#  define DLG_SPIN_YIELD 1024
+#endif
+
+#define DLG_OP_CONTAINS 0
+#define DLG_OP_ADD      1
+#define DLG_OP_REMOVE   2
+
+typedef struct ALIGNED(CACHE_LINE_SIZE) dlg_request
+{
+  volatile uint64_t seq;	/* bumped by the client for every request */
+  uint64_t op;
+  skey_t key;
+  sval_t val;
+  uint8_t padding[CACHE_LINE_SIZE - 2 * sizeof(uint64_t) - sizeof(skey_t) - sizeof(sval_t)];
+} dlg_request_t;
+
+typedef struct ALIGNED(CACHE_LINE_SIZE) dlg_response
+{
+  volatile uint64_t seq;	/* seq of the last served request */
+  volatile sval_t ret;
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(uint64_t) - sizeof(sval_t)];
+} dlg_response_t;
+
+typedef sval_t (*dlg_exec_t)(void* set, uint32_t op, skey_t key, sval_t val);
+
+typedef struct ALIGNED(CACHE_LINE_SIZE) dlg_server_stats
+{
+  uint64_t served;
+  uint64_t busy_scans;		/* scans of the clients that served requests */
+  uint8_t padding[CACHE_LINE_SIZE - 2 * sizeof(uint64_t)];
+} dlg_server_stats_t;
+
+typedef struct dlg
+{
+  size_t clients;
+  size_t servers;		/* 0: delegation is off */
+  dlg_request_t* req;
+  dlg_response_t* resp;
+  dlg_server_stats_t* stats;
+  void* set;
+  dlg_exec_t exec;
+  pthread_t* threads;
+  volatile int stop;
+} dlg_t;
+
+extern dlg_t __dlg;
+extern __thread uint32_t __dlg_client;
+
+static inline void
+dlg_client_init(uint32_t id)
+{
+  __dlg_client = id;
+}
+
+static inline sval_t
+dlg_call(uint32_t op, skey_t key, sval_t val)
+{
+  dlg_request_t* req = &__dlg.req[__dlg_client];
+  dlg_response_t* resp = &__dlg.resp[__dlg_client];
+  uint64_t seq = req->seq + 1;
+  req->op = op;
+  req->key = key;
+  req->val = val;
+  COMPILER_BARRIER();
+  req->seq = seq;
+
+  uint32_t spins = 0;
+  while (resp->seq != seq)
+    {
+      PAUSE;
+      if (unlikely(++spins == DLG_SPIN_YIELD))
+	{
+	  /* more threads than cores: let the server run */
+	  sched_yield();
+	  spins = 0;
+	}
+    }
+  COMPILER_BARRIER();
+  sval_t ret = resp->ret;
+#if GC == 1
+  /* the client never touches the nodes: let the servers reclaim memory */
+  SSMEM_SAFE_TO_RECLAIM();
+#endif
+  return ret;
+}
+
+/* the operation op of the calling thread: delegated, or local if delegation is off */
+#define DLG(op, key, val, local)					\
+  (__dlg.servers ? dlg_call((op), (skey_t) (key), (sval_t) (val)) : (local))
+
+static void*
+dlg_server(void* arg)
+{
+  uint32_t id = (uint32_t) (uintptr_t) arg;
+  uint32_t tid = __dlg.clients + id;
+  set_cpu(tid);
+  ssalloc_init();
+#if defined(CLH)
+  init_clh_thread(&clh_local_p);
+#endif
+#if GC == 1
+  alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
+  assert(alloc != NULL);
+  ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, tid);
+  HP_SSMEM_ARENA(alloc);
+#endif
+
+  dlg_server_stats_t st = { 0 };
+  uint32_t idle = 0;
+  while (__dlg.stop == 0)
+    {
+      uint64_t served = st.served;
+      size_t c;
+      for (c = id; c < __dlg.clients; c += __dlg.servers)
+	{
+	  dlg_request_t* req = &__dlg.req[c];
+	  dlg_response_t* resp = &__dlg.resp[c];
+	  uint64_t seq = req->seq;
+	  if (seq != resp->seq)
+	    {
+	      COMPILER_BARRIER();
+	      resp->ret = __dlg.exec(__dlg.set, (uint32_t) req->op, req->key, req->val);
+	      COMPILER_BARRIER();
+	      resp->seq = seq;
+	      st.served++;
+	    }
+	}
+      if (st.served != served)
+	{
+	  st.busy_scans++;
+	  idle = 0;
+	}
+      else if (unlikely(++idle == DLG_SPIN_YIELD))
+	{
+	  sched_yield();
+	  idle = 0;
+	}
+    }
+  __dlg.stats[id] = st;
+
+#if GC == 1
+  MEM_STATS_COLLECT(alloc, tid);
+  ssmem_term();
+  free(alloc);
+#endif
+  return NULL;
+}
+
+/* start the servers of the -n clients (before the clients) */
+static inline void
+dlg_start(size_t clients, size_t servers, void* set, dlg_exec_t exec)
+{
+  __dlg.clients = clients;
+  __dlg.servers = servers;
+  __dlg.set = set;
+  __dlg.exec = exec;
+  __dlg.stop = 0;
+  __dlg.req = (dlg_request_t*) memalign(CACHE_LINE_SIZE, clients * sizeof(dlg_request_t));
+  __dlg.resp = (dlg_response_t*) memalign(CACHE_LINE_SIZE, clients * sizeof(dlg_response_t));
+  __dlg.stats = (dlg_server_stats_t*) memalign(CACHE_LINE_SIZE, servers * sizeof(dlg_server_stats_t));
+  __dlg.threads = (pthread_t*) malloc(servers * sizeof(pthread_t));
+  assert(__dlg.req != NULL && __dlg.resp != NULL && __dlg.stats != NULL && __dlg.threads != NULL);
+  memset(__dlg.req, 0, clients * sizeof(dlg_request_t));
+  memset(__dlg.resp, 0, clients * sizeof(dlg_response_t));
+
+  size_t s;
+  for (s = 0; s < servers; s++)
+    {
+      if (pthread_create(&__dlg.threads[s], NULL, dlg_server, (void*) (uintptr_t) s))
+	{
+	  printf("ERROR; could not create delegation server %zu\n", s);
+	  exit(-1);
+	}
+    }
+}
+
+/* stop the servers (after the clients are done) */
+static inline void
+dlg_stop()
+{
+  __dlg.stop = 1;
+  size_t s;
+  for (s = 0; s < __dlg.servers; s++)
+    {
+      pthread_join(__dlg.threads[s], NULL);
+    }
+}
+
+static inline void
+dlg_print()
+{
+  if (__dlg.servers == 0)
+    {
+      return;
+    }
+
+  printf("#delegation: %zu servers for %zu clients\n", __dlg.servers, __dlg.clients);
+  size_t s;
+  for (s = 0; s < __dlg.servers; s++)
+    {
+      dlg_server_stats_t* st = &__dlg.stats[s];
+      printf("#server %-3zu: %-12llu ops | %.2f requests per busy scan\n", s,
+	     (long long unsigned) st->served, st->busy_scans ? (double) st->served / st->busy_scans : 0.0);
+    }
+}
+
+#define DELEGATION_VARS_DEFINITION()					\
+  dlg_t __dlg;								\
+  __thread uint32_t __dlg_client
+
+#endif	/* _DELEGATION_H_ */
@@ -0,0 +1,145 @@
+/*
+ *   File: handoff.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: producer / consumer handoff mode of the queue and stack
+ *                tests (cpu usage and handoff latency of idle consumers)
+ *   handoff.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _HANDOFF_H_
+#define _HANDOFF_H_
+
+/*
+ * With -c <n> (consumers), the last n threads only dequeue and the others
+ * only enqueue, one element every -g <us> microseconds (low load). The value
+ * of an element is the timestamp of its enqueue, so consumers measure the
+ * handoff latency (enqueue to dequeue). Consumers use the blocking dequeue
+ * (spin, then park), or the non-blocking one in a loop with -w (spin). At
+ * the end, the test prints the latency and the cpu time of the consumers as
+ * a percentage of the duration.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "getticks.h"
+
+typedef struct handoff_stats
+{
+  size_t elems;			/* measured elements */
+  ticks lat_sum;
+  ticks lat_max;
+  uint64_t cpu_ns;		/* cpu time of the consumers */
+  uint64_t wall_ns;		/* time the consumers ran */
+} handoff_stats_t;
+
+extern handoff_stats_t __handoff;
+extern ticks __handoff_t0;
+
+static inline uint64_t
+handoff_ns(clockid_t clock)
+{
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/* elements with values before the start of the test are initial keys */
+static inline void
+handoff_record(handoff_stats_t* s, ticks val)
+{
+  if (val >= __handoff_t0)
+    {
+      ticks lat = getticks() - val;
+      s->elems++;
+      s->lat_sum += lat;
+      if (lat > s->lat_max)
+	{
+	  s->lat_max = lat;
+	}
+    }
+}
+
+static inline void
+handoff_publish(handoff_stats_t* s)
+{
+  __sync_fetch_and_add(&__handoff.elems, s->elems);
+  __sync_fetch_and_add(&__handoff.lat_sum, s->lat_sum);
+  __sync_fetch_and_add(&__handoff.cpu_ns, s->cpu_ns);
+  __sync_fetch_and_add(&__handoff.wall_ns, s->wall_ns);
+  ticks max = __handoff.lat_max;
+  while (s->lat_max > max && !__sync_bool_compare_and_swap(&__handoff.lat_max, max, s->lat_max))
+    {
+      max = __handoff.lat_max;
+    }
+}
+
+static inline void
+handoff_print(size_t producers, size_t consumers, size_t gap_us, int spin, size_t parks)
+{
+  handoff_stats_t* s = &__handoff;
+  printf("#handoff: %zu producers (1 element / %zu us), %zu consumers (%s)\n",
+	 producers, gap_us, consumers, spin ? "spinning" : "blocking");
+  printf("#handoff: %zu elements | latency avg %.0f max %llu cycles | consumer cpu %.1f%% | parks %zu\n",
+	 s->elems, s->elems ? (double) s->lat_sum / s->elems : 0.0, (unsigned long long) s->lat_max,
+	 s->wall_ns ? 100.0 * s->cpu_ns / s->wall_ns : 0.0, parks);
+}
+
+/*
+ * the test loop of thread id in handoff mode: add is evaluated with __ts (the
+ * value to enqueue), remove and remove_blocking return 0 on empty
+ */
+#define HANDOFF_LOOP(id, add, remove, remove_blocking)			\
+  if ((id) < num_threads - consumers)					\
+    {									\
+      while (stop == 0)							\
+	{								\
+	  ticks __ts = getticks();					\
+	  my_putting_count_succ += ((add) != 0);			\
+	  my_putting_count++;						\
+	  if (handoff_gap_us > 0)					\
+	    {								\
+	      usleep(handoff_gap_us);					\
+	    }								\
+	}								\
+    }									\
+  else									\
+    {									\
+      handoff_stats_t __hs = { 0 };					\
+      uint64_t __cpu = handoff_ns(CLOCK_THREAD_CPUTIME_ID);		\
+      uint64_t __wall = handoff_ns(CLOCK_MONOTONIC);			\
+      while (stop == 0)							\
+	{								\
+	  sval_t __v = handoff_spin ? (remove) : (remove_blocking);	\
+	  my_removing_count++;						\
+	  if (__v != 0)							\
+	    {								\
+	      my_removing_count_succ++;					\
+	      handoff_record(&__hs, (ticks) __v);			\
+	    }								\
+	}								\
+      __hs.cpu_ns = handoff_ns(CLOCK_THREAD_CPUTIME_ID) - __cpu;	\
+      __hs.wall_ns = handoff_ns(CLOCK_MONOTONIC) - __wall;		\
+      handoff_publish(&__hs);						\
+    }
+
+#define HANDOFF_VARS_DEFINITION()					\
+  handoff_stats_t __handoff;						\
+  ticks __handoff_t0
+
+#endif	/* _HANDOFF_H_ */
@@ -0,0 +1,325 @@
+/*
+ *   File: hazard.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: hazard-pointer memory reclamation (GC == 3) with a bound on
+ *                the memory that is retired and not yet reclaimed
+ *   hazard.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _HAZARD_H_
+#define _HAZARD_H_
+
+/*
+ * Hazard pointers (Michael, 2004). Every thread owns HZD_NUM hazard pointers
+ * in a cache line of its own. Before dereferencing a node, a traversal
+ * publishes it (hzd_protect: store and full barrier) and then validates that
+ * the node is still reachable (e.g., left->next == right); otherwise it
+ * retries.
+ *
+ * A node that is unlinked is retired (hzd_retire) into a per-thread list.
+ * Every HZD_SCAN_MIN + 2 * H retires (H: the hazard pointers of all the
+ * threads), the thread reads all the hazard pointers and reclaims the
+ * retired nodes that none of them protects, i.e., at least half of the list.
+ * Thus, a thread never holds more than HZD_SCAN_MIN + 2 * H retired nodes, no
+ * matter how long other threads are descheduled (unlike ssmem, where a
+ * thread that does not advance its timestamp blocks the reclamation of all
+ * threads).
+ *
+ * Nodes come from per-thread chunks of HZD_CHUNK_SIZE bytes (bump allocated,
+ * as ssmem) and the reclaimed ones are reused before the chunk grows, so the
+ * memory used is the peak footprint of the structure plus the retired nodes.
+ * Objects have a single size per thread (the node size of hzd_thread_init).
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifndef CACHE_LINE_SIZE
+#  define CACHE_LINE_SIZE 64
+#endif
+
+#ifndef HZD_MAX_THREADS
+#  define HZD_MAX_THREADS 256
+#endif
+#ifndef HZD_NUM
+#  define HZD_NUM 2		/* hazard pointers per thread */
+#endif
+#ifndef HZD_SCAN_MIN
+#  define HZD_SCAN_MIN 64
+#endif
+#ifndef HZD_CHUNK_SIZE
+#  define HZD_CHUNK_SIZE (1 << 20)
+#endif
+
+/* the hazard pointers of the list traversals */
+#define HZD_LEFT  0
+#define HZD_RIGHT 1
+
+typedef struct hzd_slots
+{
+  void* volatile hp[HZD_NUM];
+  uint8_t padding[CACHE_LINE_SIZE - HZD_NUM * sizeof(void*)];
+} hzd_slots_t;
+
+typedef struct hzd_stats
+{
+  size_t chunk_bytes;		/* memory got from the os */
+  size_t used_bytes;		/* memory handed out of the chunks */
+  size_t retired;
+  size_t reclaimed;		/* by scans */
+  size_t scans;
+  size_t pending;		/* retired and not yet reclaimed (at the end) */
+  size_t max_pending;		/* max of one thread */
+  size_t free_objs;		/* reclaimed and not yet reused (at the end) */
+} hzd_stats_t;
+
+typedef struct hzd_thread
+{
+  hzd_slots_t* slots;
+  size_t obj_size;
+  void** retired;
+  size_t retired_num;
+  size_t retired_size;
+  void** hazards;		/* scratch space of the scans */
+  size_t hazards_size;
+  void* free_list;		/* reclaimed objects, linked through their first word */
+  uint8_t* chunk;
+  size_t chunk_curr;
+  hzd_stats_t stats;
+} hzd_thread_t;
+
+extern hzd_slots_t __hzd_slots[HZD_MAX_THREADS];
+extern volatile uint32_t __hzd_num;	/* the threads are 0 .. __hzd_num - 1 */
+extern __thread hzd_thread_t __hzd;
+extern hzd_stats_t __hzd_stats;
+
+static inline void
+hzd_thread_init(uint32_t id, size_t obj_size)
+{
+  assert(id < HZD_MAX_THREADS);
+  __hzd.slots = &__hzd_slots[id];
+  /* the low bits of the nodes are used as marks */
+  __hzd.obj_size = (obj_size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+  __hzd.chunk_curr = HZD_CHUNK_SIZE;
+
+  uint32_t num = __hzd_num;
+  while (num <= id && !__sync_bool_compare_and_swap(&__hzd_num, num, id + 1))
+    {
+      num = __hzd_num;
+    }
+}
+
+/* publish p, and order the store before the loads that validate p */
+static inline void
+hzd_protect(uint32_t i, void* p)
+{
+  __hzd.slots->hp[i] = p;
+  __sync_synchronize();
+}
+
+/* publish p, which is already protected by another hazard pointer */
+static inline void
+hzd_copy(uint32_t i, void* p)
+{
+  __hzd.slots->hp[i] = p;
+  asm volatile ("" ::: "memory");
+}
+
+static inline void
+hzd_clear()
+{
+  uint32_t i;
+  for (i = 0; i < HZD_NUM; i++)
+    {
+      __hzd.slots->hp[i] = NULL;
+    }
+}
+
+static inline void*
+hzd_alloc()
+{
+  hzd_thread_t* t = &__hzd;
+  void* obj = t->free_list;
+  if (obj != NULL)
+    {
+      t->free_list = *(void**) obj;
+      return obj;
+    }
+
+  if (__builtin_expect(t->chunk_curr + t->obj_size > HZD_CHUNK_SIZE, 0))
+    {
+      t->chunk = (uint8_t*) malloc(HZD_CHUNK_SIZE);
+      if (t->chunk == NULL)
+	{
+	  perror("malloc @ hzd_alloc");
+	  exit(1);
+	}
+      t->chunk_curr = 0;
+      t->stats.chunk_bytes += HZD_CHUNK_SIZE;
+    }
+  obj = t->chunk + t->chunk_curr;
+  t->chunk_curr += t->obj_size;
+  t->stats.used_bytes += t->obj_size;
+  return obj;
+}
+
+/* obj was never reachable by other threads: reuse it right away */
+static inline void
+hzd_free(void* obj)
+{
+  *(void**) obj = __hzd.free_list;
+  __hzd.free_list = obj;
+}
+
+static inline int
+hzd_cmp(const void* a, const void* b)
+{
+  uintptr_t x = (uintptr_t) *(void* const*) a, y = (uintptr_t) *(void* const*) b;
+  return (x > y) - (x < y);
+}
+
+static inline void
+hzd_scan()
+{
+  hzd_thread_t* t = &__hzd;
+  uint32_t num = __hzd_num;
+  if (t->hazards_size < num * HZD_NUM)
+    {
+      t->hazards_size = num * HZD_NUM;
+      t->hazards = (void**) realloc(t->hazards, t->hazards_size * sizeof(void*));
+      assert(t->hazards != NULL);
+    }
+
+  size_t n = 0;
+  uint32_t i, h;
+  for (i = 0; i < num; i++)
+    {
+      for (h = 0; h < HZD_NUM; h++)
+	{
+	  void* p = __hzd_slots[i].hp[h];
+	  if (p != NULL)
+	    {
+	      t->hazards[n++] = p;
+	    }
+	}
+    }
+  qsort(t->hazards, n, sizeof(void*), hzd_cmp);
+
+  size_t r, kept = 0;
+  for (r = 0; r < t->retired_num; r++)
+    {
+      void* obj = t->retired[r];
+      if (n > 0 && bsearch(&obj, t->hazards, n, sizeof(void*), hzd_cmp) != NULL)
+	{
+	  t->retired[kept++] = obj;
+	}
+      else
+	{
+	  hzd_free(obj);
+	}
+    }
+  t->stats.reclaimed += t->retired_num - kept;
+  t->stats.scans++;
+  t->retired_num = kept;
+}
+
+/* obj is unlinked: reclaim it once no hazard pointer protects it */
+static inline void
+hzd_retire(void* obj)
+{
+  hzd_thread_t* t = &__hzd;
+  if (__builtin_expect(t->retired_num == t->retired_size, 0))
+    {
+      t->retired_size = t->retired_size ? 2 * t->retired_size : HZD_SCAN_MIN;
+      t->retired = (void**) realloc(t->retired, t->retired_size * sizeof(void*));
+      assert(t->retired != NULL);
+    }
+  t->retired[t->retired_num++] = obj;
+  t->stats.retired++;
+  if (t->retired_num > t->stats.max_pending)
+    {
+      t->stats.max_pending = t->retired_num;
+    }
+
+  if (t->retired_num >= HZD_SCAN_MIN + 2 * HZD_NUM * __hzd_num)
+    {
+      hzd_scan();
+    }
+}
+
+/* adds the statistics of the thread to the totals; its memory is kept */
+static inline void
+hzd_thread_term()
+{
+  hzd_thread_t* t = &__hzd;
+  hzd_clear();
+
+  void* obj;
+  for (obj = t->free_list; obj != NULL; obj = *(void**) obj)
+    {
+      t->stats.free_objs++;
+    }
+  t->stats.pending = t->retired_num;
+
+  hzd_stats_t* s = &__hzd_stats;
+  __sync_fetch_and_add(&s->chunk_bytes, t->stats.chunk_bytes);
+  __sync_fetch_and_add(&s->used_bytes, t->stats.used_bytes);
+  __sync_fetch_and_add(&s->retired, t->stats.retired);
+  __sync_fetch_and_add(&s->reclaimed, t->stats.reclaimed);
+  __sync_fetch_and_add(&s->scans, t->stats.scans);
+  __sync_fetch_and_add(&s->pending, t->stats.pending);
+  __sync_fetch_and_add(&s->free_objs, t->stats.free_objs);
+  size_t max = s->max_pending;
+  while (t->stats.max_pending > max && !__sync_bool_compare_and_swap(&s->max_pending, max, t->stats.max_pending))
+    {
+      max = s->max_pending;
+    }
+}
+
+static inline void
+hzd_print(size_t obj_size)
+{
+  hzd_stats_t* s = &__hzd_stats;
+  if (__hzd_num == 0)
+    {
+      return;			/* the structure does not use hazard pointers */
+    }
+
+  double mb = 1024.0 * 1024.0;
+  size_t free_objs = s->pending + s->free_objs;
+  size_t live = (free_objs * obj_size < s->used_bytes) ? s->used_bytes - free_objs * obj_size : 0;
+
+  printf("#memory chunks    : %.2f MB\n", s->chunk_bytes / mb);
+  printf("#memory used      : %.2f MB\n", s->used_bytes / mb);
+  printf("#memory pending   : %-10zu objs (%.2f MB) | max %zu objs per thread (bound %u)\n", s->pending,
+	 s->pending * obj_size / mb, s->max_pending, HZD_SCAN_MIN + 2 * HZD_NUM * __hzd_num);
+  printf("#memory reclaimed : %-10zu objs (%.2f MB)\n", s->free_objs, s->free_objs * obj_size / mb);
+  printf("#memory live      : %.2f MB (%zu B per node)\n", live / mb, obj_size);
+  printf("#hazard scans     : %-10zu (%zu retired, %zu reclaimed, %u threads x %d hazard pointers)\n",
+	 s->scans, s->retired, s->reclaimed, __hzd_num, HZD_NUM);
+}
+
+#define HZD_VARS_DEFINITION()						\
+  hzd_slots_t __hzd_slots[HZD_MAX_THREADS] __attribute__ ((aligned (CACHE_LINE_SIZE))); \
+  volatile uint32_t __hzd_num = 0;					\
+  __thread hzd_thread_t __hzd;						\
+  hzd_stats_t __hzd_stats
+
+#endif	/* _HAZARD_H_ */
@@ -38,7 +38,7 @@ typedef struct htlock_local
 typedef struct ALIGNED(CACHE_LINE_SIZE) htlock
 {
   htlock_global_t* global;
-  htlock_local_t* local[NUMBER_OF_SOCKETS];
+  htlock_local_t* local[NUMBER_OF_LOCK_SOCKETS];
 } htlock_t;
 
 typedef struct htlock ptlock_t;
@@ -0,0 +1,244 @@
+/*
+ *   File: huge_pages.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: huge-page backed memory arenas for the node allocators
+ *   huge_pages.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _HUGE_PAGES_H_
+#define _HUGE_PAGES_H_
+
+/*
+ * The page size of the node memory is selected per run with the
+ * ASCYLIB_HUGE_PAGES environment variable:
+ *
+ *   none : memory from memalign / malloc (default)
+ *   thp  : anonymous mmap + madvise(MADV_HUGEPAGE) (transparent huge pages)
+ *   2mb  : mmap(MAP_HUGETLB) with 2MB pages
+ *   1gb  : mmap(MAP_HUGETLB) with 1GB pages
+ *
+ * The explicit huge pages come from the hugetlbfs pool
+ * (/proc/sys/vm/nr_hugepages or /sys/kernel/mm/hugepages/). If the pool
+ * cannot back a mapping, the mapping falls back to thp.
+ *
+ * With ssmem (GC == 1), HP_SSMEM_ARENA replaces the first (still unused)
+ * memory chunk of an allocator with a huge-page arena of the same size.
+ * ssmem uses the chunk size (mem_size) both to detect a full chunk and to
+ * size the next one, so the arena cannot be larger than the chunk: once the
+ * first chunk is full, ssmem continues with regular chunks exactly as
+ * without huge pages. With 1gb, the first chunk of every thread is rounded
+ * up to a whole 1GB page (only the chunk size of it is used). The arena is
+ * never unmapped (ssmem_term frees the original chunk only). Without ssmem,
+ * ssalloc_init maps its memory with the selected page size. Use PERF=1 to
+ * see the dTLB misses.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#  define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#  define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#  define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+#define HP_ENV      "ASCYLIB_HUGE_PAGES"
+
+typedef enum
+  {
+    HP_NONE = 0,
+    HP_THP,
+    HP_2MB,
+    HP_1GB,
+  } hp_mode_t;
+
+static const char* __attribute__ ((unused)) hp_mode_names[] =
+  {
+    "none", "thp", "2mb", "1gb"
+  };
+
+typedef struct huge_pages
+{
+  hp_mode_t mode;
+  volatile uint32_t fallbacks;	/* hugetlb mappings that fell back to thp */
+} huge_pages_t;
+
+extern huge_pages_t __hp;
+extern pthread_once_t __hp_once;
+
+static inline void
+hp_init()
+{
+  huge_pages_t* h = &__hp;
+  h->mode = HP_NONE;
+  h->fallbacks = 0;
+
+  const char* env = getenv(HP_ENV);
+  if (env != NULL && *env)
+    {
+      int m;
+      for (m = 0; m <= HP_1GB; m++)
+	{
+	  if (!strcmp(env, hp_mode_names[m]))
+	    {
+	      h->mode = (hp_mode_t) m;
+	      break;
+	    }
+	}
+      if (m > HP_1GB)
+	{
+	  fprintf(stderr, "** unknown %s=%s (none, thp, 2mb, 1gb)\n", HP_ENV, env);
+	}
+    }
+
+  if (h->mode != HP_NONE)
+    {
+      printf("## huge pages: %s\n", hp_mode_names[h->mode]);
+    }
+}
+
+static inline huge_pages_t*
+hp_get()
+{
+  pthread_once(&__hp_once, hp_init);
+  return &__hp;
+}
+
+static inline hp_mode_t
+hp_mode()
+{
+  return hp_get()->mode;
+}
+
+static inline size_t
+hp_page_size(hp_mode_t mode)
+{
+  switch (mode)
+    {
+    case HP_1GB:
+      return 1024 * 1024 * 1024UL;
+    case HP_2MB:
+    case HP_THP:
+      return 2 * 1024 * 1024UL;
+    default:
+      return 4096;
+    }
+}
+
+/*
+ * maps size bytes (rounded up to the page size) with the selected page size.
+ * Returns NULL if even the thp fallback fails.
+ */
+static inline void*
+hp_map(size_t* size)
+{
+  hp_mode_t mode = hp_mode();
+  void* mem = MAP_FAILED;
+
+  if (mode == HP_2MB || mode == HP_1GB)
+    {
+      size_t ps = hp_page_size(mode);
+      size_t sz = (*size + ps - 1) & ~(ps - 1);
+      int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | ((mode == HP_1GB) ? MAP_HUGE_1GB : MAP_HUGE_2MB);
+      mem = mmap(NULL, sz, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (mem != MAP_FAILED)
+	{
+	  *size = sz;
+	  return mem;
+	}
+
+      if (__sync_fetch_and_add(&__hp.fallbacks, 1) == 0)
+	{
+	  fprintf(stderr, "** huge pages: mmap(MAP_HUGETLB, %s) of %zu MB failed, falling back to thp\n",
+		  hp_mode_names[mode], sz >> 20);
+	}
+    }
+
+  size_t ps = hp_page_size(HP_THP);
+  size_t sz = (*size + ps - 1) & ~(ps - 1);
+  /* over-map by a huge page, so that the arena can start on a huge-page boundary */
+  mem = mmap(NULL, sz + ps, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    {
+      return NULL;
+    }
+  uintptr_t start = ((uintptr_t) mem + ps - 1) & ~(ps - 1);
+  if (start > (uintptr_t) mem)
+    {
+      munmap(mem, start - (uintptr_t) mem);
+    }
+  uintptr_t end = (uintptr_t) mem + sz + ps;
+  if (end > start + sz)
+    {
+      munmap((void*) (start + sz), end - (start + sz));
+    }
+#if defined(MADV_HUGEPAGE)
+  madvise((void*) start, sz, MADV_HUGEPAGE);
+#endif
+  *size = sz;
+  return (void*) start;
+}
+
+#if GC == 1
+#  include "ssmem.h"
+
+/*
+ * gives a huge-page arena to a freshly initialized ssmem allocator, as its
+ * first chunk. The original chunk stays in the chunk list of the allocator
+ * (it is untouched, so it only costs address space) and is freed by
+ * ssmem_term; the arena is never unmapped (it is released at process exit).
+ * mem_size is left alone, so ssmem uses mem_size bytes of the arena (the
+ * rest of a 1GB page is unused) and sizes the later chunks as usual.
+ */
+static inline void
+hp_ssmem_arena(ssmem_allocator_t* a)
+{
+  if (hp_mode() == HP_NONE || a->mem_curr != 0)
+    {
+      return;
+    }
+
+  size_t size = a->mem_size;
+  void* mem = hp_map(&size);
+  if (mem == NULL)
+    {
+      return;
+    }
+
+  a->tot_size = a->tot_size - a->mem_size + size;
+  a->mem = mem;
+}
+
+#  define HP_SSMEM_ARENA(a) hp_ssmem_arena(a)
+#else
+#  define HP_SSMEM_ARENA(a)
+#endif	/* GC */
+
+#define HP_VARS_DEFINITION()						\
+  huge_pages_t __hp;							\
+  pthread_once_t __hp_once = PTHREAD_ONCE_INIT
+
+#endif	/* _HUGE_PAGES_H_ */
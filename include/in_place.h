@@ -0,0 +1,182 @@
+/*
+ *   File: in_place.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: in-place update (put / replace / cas_value) mode of the
+ *                set tests
+ *   in_place.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _IN_PLACE_H_
+#define _IN_PLACE_H_
+
+/*
+ * With -U, the inserts of the test loop rotate over put, replace, and
+ * cas_value (the initial fill only puts). Only a put of a missing key
+ * inserts, so a successful insert still means a new key and the size check
+ * holds. The value of key k is k, or k with IN_PLACE_TAG set: every update
+ * flips the tag, and every previous value that an update returns (or that
+ * cas_value expects) is checked to be one of the two. A put that returns
+ * IN_PLACE_PUT_FULL (define it before including this file, e.g., for a
+ * full bucket of the OPTIK map) neither inserts nor updates, and counts as
+ * a failed put.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "common.h"
+
+#define IN_PLACE_TAG ((sval_t) 1 << 40)
+
+typedef struct in_place_stats
+{
+  size_t puts;
+  size_t puts_upd;		/* puts of present keys (in-place updates) */
+  size_t puts_full;
+  size_t replaces;
+  size_t replaces_succ;
+  size_t cas;
+  size_t cas_succ;
+  size_t wrong;			/* updates that returned or saw a wrong value */
+} in_place_stats_t;
+
+extern __thread in_place_stats_t __in_place;
+extern __thread uint32_t __in_place_started;
+extern in_place_stats_t __in_place_total;
+
+static inline int
+in_place_put_full(sval_t old)
+{
+#if defined(IN_PLACE_PUT_FULL)
+  return old == IN_PLACE_PUT_FULL;
+#else
+  (void) old;
+  return 0;
+#endif
+}
+
+static inline sval_t
+in_place_flip(sval_t val)
+{
+  return val ^ IN_PLACE_TAG;
+}
+
+static inline void
+in_place_check(in_place_stats_t* s, skey_t key, sval_t val)
+{
+  if (unlikely((val & ~IN_PLACE_TAG) != (sval_t) key))
+    {
+      if (s->wrong++ == 0)
+	{
+	  printf("// WRONG in-place value of key %ld: %ld\n", (long) key, (long) val);
+	}
+    }
+}
+
+/* after the initial fill: the inserts of the thread rotate over the update
+   operations from now on, and only these are counted */
+static inline void
+in_place_start()
+{
+  in_place_stats_t zero = { 0 };
+  __in_place = zero;
+  __in_place_started = 1;
+}
+
+/*
+ * the insert of the test loop with -U, on the (shard) set s: evaluates to
+ * 1 if the key was inserted. contains must return the value of the key.
+ */
+#define IN_PLACE_ADD(s, k, put, replace, cas_value, contains)		\
+  ({									\
+    in_place_stats_t* __ip = &__in_place;				\
+    int __ins = 0;							\
+    sval_t __old;							\
+    switch (__in_place_started ? (__ip->puts + __ip->replaces + __ip->cas) % 3 : 0) \
+      {									\
+      case 0:								\
+	__ip->puts++;							\
+	__old = put(s, k, (sval_t) (k));				\
+	if (__old == 0)							\
+	  {								\
+	    __ins = 1;							\
+	  }								\
+	else if (in_place_put_full(__old))				\
+	  {								\
+	    __ip->puts_full++;						\
+	  }								\
+	else								\
+	  {								\
+	    __ip->puts_upd++;						\
+	    in_place_check(__ip, k, __old);				\
+	  }								\
+	break;								\
+      case 1:								\
+	__ip->replaces++;						\
+	__old = replace(s, k, in_place_flip((sval_t) (k)));		\
+	if (__old != 0)							\
+	  {								\
+	    __ip->replaces_succ++;					\
+	    in_place_check(__ip, k, __old);				\
+	  }								\
+	break;								\
+      default:								\
+	__ip->cas++;							\
+	__old = contains(s, k);						\
+	if (__old != 0)							\
+	  {								\
+	    in_place_check(__ip, k, __old);				\
+	    __ip->cas_succ += (cas_value(s, k, __old, in_place_flip(__old)) != 0); \
+	  }								\
+	break;								\
+      }									\
+    __ins;								\
+  })
+
+static inline void
+in_place_publish()
+{
+  in_place_stats_t* s = &__in_place;
+  in_place_stats_t* t = &__in_place_total;
+  __sync_fetch_and_add(&t->puts, s->puts);
+  __sync_fetch_and_add(&t->puts_upd, s->puts_upd);
+  __sync_fetch_and_add(&t->puts_full, s->puts_full);
+  __sync_fetch_and_add(&t->replaces, s->replaces);
+  __sync_fetch_and_add(&t->replaces_succ, s->replaces_succ);
+  __sync_fetch_and_add(&t->cas, s->cas);
+  __sync_fetch_and_add(&t->cas_succ, s->cas_succ);
+  __sync_fetch_and_add(&t->wrong, s->wrong);
+}
+
+static inline void
+in_place_print()
+{
+  in_place_stats_t* t = &__in_place_total;
+  printf("#in-place: puts %zu (%zu updates, %zu full) | replaces %zu (%zu hits) | cas_value %zu (%zu succ)\n",
+	 t->puts, t->puts_upd, t->puts_full, t->replaces, t->replaces_succ, t->cas, t->cas_succ);
+  if (t->wrong > 0)
+    {
+      printf("// WRONG in-place values: %zu\n", t->wrong);
+    }
+}
+
+#define IN_PLACE_VARS_DEFINITION()					\
+  __thread in_place_stats_t __in_place;					\
+  __thread uint32_t __in_place_started = 0;				\
+  in_place_stats_t __in_place_total
+
+#endif	/* _IN_PLACE_H_ */
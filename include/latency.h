@@ -34,13 +34,15 @@
 #ifndef _LATENCY_H_
 #define _LATENCY_H_
 
+#include "backoff.h"
+
 #if RETRY_STATS == 1
 #  define RETRY_STATS_VARS						\
   __thread size_t __parse_try, __update_try, __cleanup_try, __lock_try, __lock_queue, __lock_try_once, \
     __node_cache_hit
 #  define RETRY_STATS_VARS_GLOBAL					\
   size_t __parse_try_global, __update_try_global, __cleanup_try_global, __lock_try_global, __lock_queue_global, \
-    __node_cache_hit_global
+    __node_cache_hit_global, __backoff_pauses_global, __backoff_cycles_global
 
 extern RETRY_STATS_VARS;
 extern RETRY_STATS_VARS_GLOBAL;
@@ -52,7 +54,9 @@ extern RETRY_STATS_VARS_GLOBAL;
   __lock_try = 0;				\
   __lock_queue = 0;				\
   __lock_try_once = 1;				\
-  __node_cache_hit = 0;
+  __node_cache_hit = 0;				\
+  __backoff.pauses = 0;				\
+  __backoff.cycles = 0;
 
 #  define PARSE_TRY()        __parse_try++
 #  define UPDATE_TRY()       __update_try++
@@ -79,7 +83,9 @@ extern RETRY_STATS_VARS_GLOBAL;
   __cleanup_try_global += __cleanup_try;	\
   __lock_try_global += __lock_try;		\
   __lock_queue_global += __lock_queue;		\
-  __node_cache_hit_global += __node_cache_hit;
+  __node_cache_hit_global += __node_cache_hit;	\
+  __backoff_pauses_global += __backoff.pauses;	\
+  __backoff_cycles_global += __backoff.cycles;
 
 static inline void 
 retry_stats_print(size_t thr, size_t put, size_t rem, size_t upd_suc)
@@ -102,6 +108,7 @@ retry_stats_print(size_t thr, size_t put, size_t rem, size_t upd_suc)
   
   printf("#cache_hit:    %-10zu %-10zu %f\n", __parse_try_global, __node_cache_hit_global,
 	 (double) __node_cache_hit_global / __parse_try_global);
+  backoff_stats_print(__backoff_pauses_global, __backoff_cycles_global, updates);
 }
 
 #else  /* RETRY_STATS == 0 */
@@ -382,6 +382,24 @@ ticket_unlock(volatile ptlock_t* l)
 #  define GL_LOCK(lock)					htlock_lock((htlock_t*) lock)
 #  define GL_UNLOCK(lock)				htlock_release((htlock_t*) lock)
 
+#elif defined(COHORT)		/* cohort (NUMA-aware) OPTIK lock */
+
+#  include "optik_cohort.h"
+
+typedef optik_cohort_t ptlock_t;
+#  define LOCK_LOCAL_DATA                               OPTIK_COHORT_LOCAL_DATA
+#  define INIT_LOCK(lock)				optik_cohort_init((optik_cohort_t*) lock)
+#  define DESTROY_LOCK(lock)			
+#  define LOCK(lock)					optik_cohort_lock((optik_cohort_t*) lock)
+#  define TRYLOCK(lock)					optik_cohort_trylock((optik_cohort_t*) lock)
+#  define UNLOCK(lock)					optik_cohort_unlock((optik_cohort_t*) lock)
+/* GLOBAL lock */
+#  define GL_INIT_LOCK(lock)				optik_cohort_init((optik_cohort_t*) lock)
+#  define GL_DESTROY_LOCK(lock)			
+#  define GL_LOCK(lock)					optik_cohort_lock((optik_cohort_t*) lock)
+#  define GL_TRYLOCK(lock)				optik_cohort_trylock((optik_cohort_t*) lock)
+#  define GL_UNLOCK(lock)				optik_cohort_unlock((optik_cohort_t*) lock)
+
 #elif defined(CLH)		/* CLH lock */
 
 #  include "clh.h"
@@ -0,0 +1,320 @@
+/*
+ *   File: mem_stats.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: memory footprint accounting (ssmem allocators and data structures)
+ *   mem_stats.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _MEM_STATS_H_
+#define _MEM_STATS_H_
+
+/*
+ * With GC == 1, every thread adds the state of its ssmem allocator to global
+ * totals right before ssmem_term (MEM_STATS_COLLECT). At the end of the run,
+ * MEM_STATS_PRINT prints:
+ *   chunks    : memory the allocators got from the os
+ *   used      : memory handed out of the chunks (bump allocated)
+ *   pending   : freed objects waiting for a gc pass (the free_set_list)
+ *   reclaimed : objects reclaimed by gc and not yet reused (collected_set_list)
+ *   released  : objects given back with ssmem_release and not yet returned
+ *   live      : used - (pending + reclaimed) objects
+ * ssmem does not keep the size of the objects, so objects are converted to
+ * bytes with the nominal node size of the data structure (sizeof(DS_NODE)).
+ * If the harness defines DS_MEMORY(set), the bytes reachable from the data
+ * structure and the bytes per key are printed as well.
+ *
+ * With SSMEM_GC_STATS == 1 (make GC_STATS=1), ssmem_free is wrapped in order
+ * to measure the gc passes that ssmem runs every SSMEM_GC_FREE_SET_SIZE frees
+ * (when the current free set is full). Per thread:
+ *   passes      : gc passes, and how many of them reclaimed free sets
+ *   pass time   : total and max time spent in the ssmem_free calls that did a pass
+ *   max pending : max objects freed and not yet reclaimed
+ *   max lag     : max time between two reclaiming passes (or between the last
+ *                 one and the end of the run), i.e., how long freed memory can
+ *                 wait before it can be reused
+ * A thread that does not make progress (see GC_STALL) blocks reclamation for
+ * all the threads, so these numbers bound the memory under scheduling noise.
+ *
+ * With GC == 3 (hazard pointers, see hazard.h), MEM_STATS_PRINT prints the
+ * same chunks / used / pending / reclaimed / live figures of the hazard
+ * allocators, the max pending objects of a thread, and the scans.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+
+/* ms the last thread sleeps at the start of the test (0: no stall) */
+extern size_t gc_stall_ms;
+
+#define GC_STALL(id, num_threads)					\
+  if (gc_stall_ms > 0 && (id) == (num_threads) - 1)			\
+    {									\
+      printf("## stalling thread %u for %zu ms\n", (uint32_t) (id), gc_stall_ms); \
+      usleep(gc_stall_ms * 1000);					\
+    }
+
+static inline void
+mem_stats_print_ds(size_t ds_bytes, size_t num_keys)
+{
+  if (ds_bytes > 0)
+    {
+      printf("#memory ds        : %.2f MB / %.1f B per key\n", ds_bytes / (1024.0 * 1024.0),
+	     num_keys ? (double) ds_bytes / num_keys : 0.0);
+    }
+}
+
+#if GC == 1
+
+#include "ssmem.h"
+
+#ifndef SSMEM_GC_STATS
+#  define SSMEM_GC_STATS 0
+#endif
+
+typedef struct mem_stats
+{
+  size_t chunk_bytes;
+  size_t used_bytes;
+  size_t pending_objs;
+  size_t reclaimed_objs;
+  size_t released_objs;
+} mem_stats_t;
+
+extern mem_stats_t __mem_stats;
+
+#if SSMEM_GC_STATS == 1
+
+#define GC_STATS_MAX_THREADS 256
+
+typedef struct gc_stats
+{
+  size_t frees;
+  size_t passes;
+  size_t reclaiming_passes;
+  uint64_t pass_ns;
+  uint64_t max_pass_ns;
+  size_t max_pending;
+  uint64_t last_reclaim_ns;
+  uint64_t max_lag_ns;
+} gc_stats_t;
+
+extern __thread gc_stats_t __gc_stats;
+extern gc_stats_t __gc_stats_all[GC_STATS_MAX_THREADS];
+extern size_t __gc_stats_num;
+
+static inline uint64_t
+gc_stats_now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static inline size_t
+gc_stats_pending(ssmem_allocator_t* a)
+{
+  return (a->free_set_num - 1) * a->fs_size + a->free_set_list->curr;
+}
+
+static inline void
+ssmem_free_stats(ssmem_allocator_t* a, void* obj)
+{
+  gc_stats_t* s = &__gc_stats;
+  if (__builtin_expect(s->frees++ == 0, 0))
+    {
+      s->last_reclaim_ns = gc_stats_now();
+    }
+
+  ssmem_free_set_t* fs = a->free_set_list;
+  if (__builtin_expect(fs->curr < (long int) fs->size, 1))
+    {
+      (ssmem_free)(a, obj);
+      return;
+    }
+
+  /* the free set is full: this call collects the timestamps and tries to reclaim */
+  size_t sets = a->free_set_num;
+  uint64_t start = gc_stats_now();
+  (ssmem_free)(a, obj);
+  uint64_t end = gc_stats_now();
+
+  s->passes++;
+  s->pass_ns += end - start;
+  if (end - start > s->max_pass_ns)
+    {
+      s->max_pass_ns = end - start;
+    }
+
+  /* without reclamation, a new free set is appended (sets + 1) */
+  if (a->free_set_num <= sets)
+    {
+      s->reclaiming_passes++;
+      if (end - s->last_reclaim_ns > s->max_lag_ns)
+	{
+	  s->max_lag_ns = end - s->last_reclaim_ns;
+	}
+      s->last_reclaim_ns = end;
+    }
+
+  size_t pending = gc_stats_pending(a);
+  if (pending > s->max_pending)
+    {
+      s->max_pending = pending;
+    }
+}
+
+#  define ssmem_free(a, obj) ssmem_free_stats(a, obj)
+
+static inline void
+gc_stats_collect(ssmem_allocator_t* a, size_t id)
+{
+  gc_stats_t* s = &__gc_stats;
+  if (s->frees > 0 && gc_stats_pending(a) > 0)
+    {
+      /* freed memory that is still waiting at the end of the run */
+      uint64_t lag = gc_stats_now() - s->last_reclaim_ns;
+      if (lag > s->max_lag_ns)
+	{
+	  s->max_lag_ns = lag;
+	}
+    }
+
+  __sync_fetch_and_add(&__gc_stats_num, 1);
+  if (id < GC_STATS_MAX_THREADS)
+    {
+      __gc_stats_all[id] = *s;
+    }
+}
+
+static inline void
+gc_stats_print()
+{
+  gc_stats_t t = { 0 };
+  size_t n = (__gc_stats_num < GC_STATS_MAX_THREADS) ? __gc_stats_num : GC_STATS_MAX_THREADS;
+  size_t i;
+
+  printf("#gc %-6s %-10s %-8s %-10s %-14s %-13s %-11s %s\n", "thread", "frees", "passes", "reclaiming",
+	 "pass time(us)", "max pass(us)", "max pending", "max lag(ms)");
+  for (i = 0; i < n; i++)
+    {
+      gc_stats_t* s = &__gc_stats_all[i];
+      printf("#gc %-6zu %-10zu %-8zu %-10zu %-14.1f %-13.1f %-11zu %.3f\n", i, s->frees, s->passes,
+	     s->reclaiming_passes, s->pass_ns / 1e3, s->max_pass_ns / 1e3, s->max_pending,
+	     s->max_lag_ns / 1e6);
+      t.frees += s->frees;
+      t.passes += s->passes;
+      t.reclaiming_passes += s->reclaiming_passes;
+      t.pass_ns += s->pass_ns;
+      t.max_pass_ns = (s->max_pass_ns > t.max_pass_ns) ? s->max_pass_ns : t.max_pass_ns;
+      t.max_pending += s->max_pending;
+      t.max_lag_ns = (s->max_lag_ns > t.max_lag_ns) ? s->max_lag_ns : t.max_lag_ns;
+    }
+  printf("#gc %-6s %-10zu %-8zu %-10zu %-14.1f %-13.1f %-11zu %.3f\n", "total", t.frees, t.passes,
+	 t.reclaiming_passes, t.pass_ns / 1e3, t.max_pass_ns / 1e3, t.max_pending, t.max_lag_ns / 1e6);
+}
+
+#  define GC_STATS_VARS_DEFINITION()					\
+  __thread gc_stats_t __gc_stats;					\
+  gc_stats_t __gc_stats_all[GC_STATS_MAX_THREADS];			\
+  size_t __gc_stats_num = 0;
+#  define GC_STATS_COLLECT(a, id) gc_stats_collect(a, id)
+#  define GC_STATS_PRINT()    gc_stats_print()
+
+#else  /* SSMEM_GC_STATS != 1 */
+
+#  define GC_STATS_VARS_DEFINITION()
+#  define GC_STATS_COLLECT(a, id)
+#  define GC_STATS_PRINT()
+
+#endif	/* SSMEM_GC_STATS */
+
+static inline size_t
+mem_stats_set_objs(struct ssmem_free_set* fs)
+{
+  size_t n = 0;
+  for (; fs != NULL; fs = fs->set_next)
+    {
+      n += (fs->curr > 0) ? fs->curr : 0;
+    }
+  return n;
+}
+
+static inline void
+mem_stats_collect(ssmem_allocator_t* a, size_t id)
+{
+  if (a == NULL)
+    {
+      return;
+    }
+  /* all chunks but the current one are full */
+  size_t used = a->tot_size - a->mem_size + a->mem_curr;
+  __sync_fetch_and_add(&__mem_stats.chunk_bytes, a->tot_size);
+  __sync_fetch_and_add(&__mem_stats.used_bytes, used);
+  __sync_fetch_and_add(&__mem_stats.pending_objs, mem_stats_set_objs(a->free_set_list));
+  __sync_fetch_and_add(&__mem_stats.reclaimed_objs, mem_stats_set_objs(a->collected_set_list));
+  __sync_fetch_and_add(&__mem_stats.released_objs, a->released_num);
+  GC_STATS_COLLECT(a, id);
+}
+
+static inline void
+mem_stats_print(size_t ds_bytes, size_t num_keys, size_t obj_size)
+{
+  mem_stats_t* s = &__mem_stats;
+  double mb = 1024.0 * 1024.0;
+  size_t free_objs = s->pending_objs + s->reclaimed_objs;
+  size_t live = (free_objs * obj_size < s->used_bytes) ? s->used_bytes - free_objs * obj_size : 0;
+
+  printf("#memory chunks    : %.2f MB\n", s->chunk_bytes / mb);
+  printf("#memory used      : %.2f MB\n", s->used_bytes / mb);
+  printf("#memory pending   : %-10zu objs (%.2f MB)\n", s->pending_objs, s->pending_objs * obj_size / mb);
+  printf("#memory reclaimed : %-10zu objs (%.2f MB)\n", s->reclaimed_objs, s->reclaimed_objs * obj_size / mb);
+  printf("#memory released  : %-10zu objs (%.2f MB)\n", s->released_objs, s->released_objs * obj_size / mb);
+  printf("#memory live      : %.2f MB (%zu B per node)\n", live / mb, obj_size);
+  mem_stats_print_ds(ds_bytes, num_keys);
+  GC_STATS_PRINT();
+}
+
+#  define MEM_STATS_VARS_DEFINITION()					\
+  GC_STATS_VARS_DEFINITION()						\
+  size_t gc_stall_ms = 0;						\
+  mem_stats_t __mem_stats
+#  define MEM_STATS_COLLECT(a, id)     mem_stats_collect(a, id)
+#  define MEM_STATS_PRINT(ds_bytes, num_keys, obj_size) mem_stats_print(ds_bytes, num_keys, obj_size)
+
+#elif GC == 3
+
+#include "hazard.h"
+
+#  define MEM_STATS_VARS_DEFINITION()					\
+  HZD_VARS_DEFINITION();						\
+  size_t gc_stall_ms = 0
+#  define MEM_STATS_COLLECT(a, id)
+#  define MEM_STATS_PRINT(ds_bytes, num_keys, obj_size)		\
+  { hzd_print(obj_size); mem_stats_print_ds(ds_bytes, num_keys); }
+
+#else  /* GC == 0 */
+
+#  define MEM_STATS_VARS_DEFINITION()  size_t gc_stall_ms = 0
+#  define MEM_STATS_COLLECT(a, id)
+#  define MEM_STATS_PRINT(ds_bytes, num_keys, obj_size) mem_stats_print_ds(ds_bytes, num_keys)
+
+#endif	/* GC */
+
+#endif	/* _MEM_STATS_H_ */
@@ -0,0 +1,172 @@
+/*
+ *   File: node_cache.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: per-thread multi-entry finger (node) cache
+ *   node_cache.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _NODE_CACHE_H_
+#define _NODE_CACHE_H_
+
+/*
+ * Generalization of the single node_last entry of linkedlist-optik_cache.
+ * Each thread keeps NODE_CACHE_ENTRIES fingers: a node, the range of keys
+ * [key_lo, key_hi) whose search can start from that node, the number of
+ * levels the node covers (skip lists), and the (OPTIK) version of the node
+ * when it was cached. The data structure validates the version before using
+ * a finger, exactly as with node_last.
+ *
+ * With GC == 1, the cache is also tagged with the ssmem timestamp of the
+ * thread: ssmem increments it on every ssmem_free of the thread, after which
+ * any reference taken before may point to reclaimed memory. A change of
+ * the timestamp thus empties the cache.
+ *
+ * Compile with NODE_CACHE=<entries> to enable (default is 0 = disabled).
+ */
+
+#ifndef NODE_CACHE_ENTRIES
+#  define NODE_CACHE_ENTRIES 0
+#endif
+
+#if NODE_CACHE_ENTRIES > 0
+
+#include <stdint.h>
+#include "common.h"
+#include "ssmem.h"
+
+typedef struct node_cache_entry
+{
+  skey_t key_lo;
+  skey_t key_hi;
+  void* node;
+  uint32_t levels;
+  uint64_t version;
+} node_cache_entry_t;
+
+typedef struct node_cache
+{
+  node_cache_entry_t entries[NODE_CACHE_ENTRIES];
+  uint32_t victim;
+  size_t ts;
+} node_cache_t;
+
+extern __thread node_cache_t __node_cache;
+#if GC == 1
+extern __thread ssmem_allocator_t* alloc;
+#  define NODE_CACHE_TS()  alloc->ts->version
+#else
+#  define NODE_CACHE_TS()  0
+#endif
+
+static inline void
+node_cache_clear()
+{
+  int i;
+  for (i = 0; i < NODE_CACHE_ENTRIES; i++)
+    {
+      __node_cache.entries[i].node = NULL;
+    }
+}
+
+static inline int
+node_cache_is_stale()
+{
+  if (unlikely(__node_cache.ts != NODE_CACHE_TS()))
+    {
+      node_cache_clear();
+      __node_cache.ts = NODE_CACHE_TS();
+      return 1;
+    }
+  return 0;
+}
+
+/*
+ * returns the closest finger for key (the one with the largest key_lo, and
+ * then the smallest key_hi) that covers at least min_levels levels, or NULL
+ */
+static inline node_cache_entry_t*
+node_cache_get(skey_t key, uint32_t min_levels)
+{
+  if (node_cache_is_stale())
+    {
+      return NULL;
+    }
+
+  node_cache_entry_t* best = NULL;
+  int i;
+  for (i = 0; i < NODE_CACHE_ENTRIES; i++)
+    {
+      node_cache_entry_t* e = &__node_cache.entries[i];
+      if (e->node != NULL && e->key_lo <= key && key < e->key_hi && e->levels >= min_levels)
+	{
+	  if (best == NULL || e->key_lo > best->key_lo ||
+	      (e->key_lo == best->key_lo && e->key_hi < best->key_hi))
+	    {
+	      best = e;
+	    }
+	}
+    }
+  return best;
+}
+
+/* caches node; an existing entry for the same node is updated in place */
+static inline void
+node_cache_put(void* node, skey_t key_lo, skey_t key_hi, uint32_t levels, uint64_t version)
+{
+  node_cache_is_stale();
+
+  node_cache_entry_t* e = NULL;
+  int i;
+  for (i = 0; i < NODE_CACHE_ENTRIES; i++)
+    {
+      if (__node_cache.entries[i].node == node)
+	{
+	  e = &__node_cache.entries[i];
+	  break;
+	}
+    }
+
+  if (e == NULL)
+    {
+      e = &__node_cache.entries[__node_cache.victim];
+      __node_cache.victim = (__node_cache.victim + 1) % NODE_CACHE_ENTRIES;
+    }
+
+  e->key_lo = key_lo;
+  e->key_hi = key_hi;
+  e->levels = levels;
+  e->version = version;
+  e->node = node;
+}
+
+static inline void
+node_cache_drop(node_cache_entry_t* e)
+{
+  e->node = NULL;
+}
+
+#  define NODE_CACHE_VARS_DEFINITION()		\
+  __thread node_cache_t __node_cache
+
+#else  /* NODE_CACHE_ENTRIES == 0 */
+
+#  define NODE_CACHE_VARS_DEFINITION()
+
+#endif	/* NODE_CACHE_ENTRIES */
+
+#endif	/* _NODE_CACHE_H_ */
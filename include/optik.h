@@ -298,7 +298,7 @@ optik_lock_backoff(optik_t* ol)
 	  break;
 	}
       const uint32_t di = (distance > 0) ? distance : -distance;
-      cpause(di << 8);
+      cpause(BACKOFF_QUEUED(di));
     }
   while (1);
 
@@ -336,7 +336,7 @@ optik_lock_version_backoff(optik_t* ol, optik_t ol_old)
 	  break;
 	}
       const uint32_t di = (distance > 0) ? distance : -distance;
-      cpause(di << 8);
+      cpause(BACKOFF_QUEUED(di));
     }
   while (1);
 
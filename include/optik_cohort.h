@@ -0,0 +1,212 @@
+/*
+ *   File: optik_cohort.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: hierarchical (cohort) OPTIK lock
+ *   optik_cohort.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _H_OPTIK_COHORT_
+#define _H_OPTIK_COHORT_
+
+#include <stdint.h>
+#include <sched.h>
+#include <atomic_ops.h>
+
+#include "common.h"
+#include "utils.h"
+
+/*
+ * A cohort lock (ticket-ticket) with an OPTIK version. Threads first get the
+ * ticket lock of their socket and then the global ticket lock. On release,
+ * if there are waiters on the same socket, the global lock is passed to the
+ * next local waiter together with the local lock (at most
+ * OPTIK_COHORT_MAX_BATCH times in a row, for fairness across sockets).
+ *
+ * The version is incremented when the lock is acquired and when it is
+ * released (odd: locked), as with OPTIK-integer. It is kept separately from
+ * the lock words, so a version can be validated only after acquiring the lock
+ * (like OPTIK-separate): optik_cohort_trylock_version fails fast only if the
+ * version has already changed.
+ *
+ * All-zero memory is a free lock.
+ */
+
+#ifndef OPTIK_COHORT_MAX_BATCH
+#  define OPTIK_COHORT_MAX_BATCH 64
+#endif
+
+typedef uint64_t optik_cohort_version_t;
+
+typedef struct optik_cohort_local
+{
+  volatile uint32_t nxt;
+  volatile uint32_t cur;
+  volatile uint32_t top_granted; /* the global lock came with the local one */
+  uint32_t batch;		 /* consecutive local handoffs */
+  uint8_t padding[CACHE_LINE_SIZE - 4 * sizeof(uint32_t)];
+} optik_cohort_local_t;
+
+typedef struct ALIGNED(CACHE_LINE_SIZE) optik_cohort
+{
+  volatile optik_cohort_version_t version;
+  volatile uint32_t nxt;
+  volatile uint32_t cur;
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(optik_cohort_version_t) - 2 * sizeof(uint32_t)];
+  optik_cohort_local_t local[NUMBER_OF_LOCK_SOCKETS];
+} optik_cohort_t;
+
+/* socket of the calling thread, found on first use (threads are already pinned) */
+extern __thread int32_t __optik_cohort_node;
+#define OPTIK_COHORT_LOCAL_DATA  __thread int32_t __optik_cohort_node = -1
+
+static inline uint32_t
+optik_cohort_node()
+{
+  if (unlikely(__optik_cohort_node < 0))
+    {
+      int cpu = sched_getcpu();
+      __optik_cohort_node = (cpu < 0) ? 0 : (get_cpu_socket(cpu) % NUMBER_OF_LOCK_SOCKETS);
+    }
+  return __optik_cohort_node;
+}
+
+static inline void
+optik_cohort_init(optik_cohort_t* ol)
+{
+  ol->version = 0;
+  ol->nxt = ol->cur = 0;
+  int s;
+  for (s = 0; s < NUMBER_OF_LOCK_SOCKETS; s++)
+    {
+      ol->local[s].nxt = ol->local[s].cur = 0;
+      ol->local[s].top_granted = 0;
+      ol->local[s].batch = 0;
+    }
+}
+
+static inline optik_cohort_version_t
+optik_cohort_get_version(optik_cohort_t* ol)
+{
+  return ol->version;
+}
+
+static inline int
+optik_cohort_is_locked(optik_cohort_version_t v)
+{
+  return (v & 0x1);
+}
+
+static inline void
+optik_cohort_acquire(optik_cohort_t* ol)
+{
+  optik_cohort_local_t* l = &ol->local[optik_cohort_node()];
+  uint32_t ticket = FAI_U32(&l->nxt);
+  while (l->cur != ticket)
+    {
+      PAUSE;
+    }
+
+  if (l->top_granted)
+    {
+      l->top_granted = 0;
+      return;
+    }
+
+  ticket = FAI_U32(&ol->nxt);
+  while (ol->cur != ticket)
+    {
+      PAUSE;
+    }
+}
+
+static inline void
+optik_cohort_release(optik_cohort_t* ol)
+{
+  optik_cohort_local_t* l = &ol->local[optik_cohort_node()];
+  if ((l->nxt - l->cur) > 1 && l->batch < OPTIK_COHORT_MAX_BATCH)
+    {
+      l->batch++;
+      l->top_granted = 1;
+    }
+  else
+    {
+      l->batch = 0;
+      COMPILER_NO_REORDER(ol->cur++);
+    }
+  COMPILER_NO_REORDER(l->cur++);
+}
+
+static inline void
+optik_cohort_lock(optik_cohort_t* ol)
+{
+  optik_cohort_acquire(ol);
+  COMPILER_NO_REORDER(ol->version++);
+}
+
+static inline optik_cohort_version_t
+optik_cohort_unlock(optik_cohort_t* ol)
+{
+  optik_cohort_version_t v = ++ol->version;
+  COMPILER_NO_REORDER(optik_cohort_release(ol));
+  return v;
+}
+
+/*
+ * locks the lock if its version is still ol_old. Might wait for the lock if
+ * the version is unchanged when called.
+ */
+static inline int
+optik_cohort_trylock_version(optik_cohort_t* ol, optik_cohort_version_t ol_old)
+{
+  if (unlikely(optik_cohort_is_locked(ol_old) || ol->version != ol_old))
+    {
+      return 0;
+    }
+
+  optik_cohort_acquire(ol);
+  if (unlikely(ol->version != ol_old))
+    {
+      optik_cohort_release(ol);
+      return 0;
+    }
+  COMPILER_NO_REORDER(ol->version++);
+  return 1;
+}
+
+/* non-blocking: fails if the lock is held or there are waiters */
+static inline int
+optik_cohort_trylock(optik_cohort_t* ol)
+{
+  optik_cohort_local_t* l = &ol->local[optik_cohort_node()];
+  uint32_t lcur = l->cur;
+  if (l->nxt != lcur || CAS_U32(&l->nxt, lcur, lcur + 1) != lcur)
+    {
+      return 0;
+    }
+
+  uint32_t gcur = ol->cur;
+  if (ol->nxt != gcur || CAS_U32(&ol->nxt, gcur, gcur + 1) != gcur)
+    {
+      COMPILER_NO_REORDER(l->cur++);
+      return 0;
+    }
+  COMPILER_NO_REORDER(ol->version++);
+  return 1;
+}
+
+#endif	/* _H_OPTIK_COHORT_ */
@@ -0,0 +1,168 @@
+/*
+ *   File: parking.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: spin-then-park support for blocking dequeues on empty
+ *                queues and stacks
+ *   parking.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _PARKING_H_
+#define _PARKING_H_
+
+/*
+ * An event count on a futex word. A consumer that finds the structure empty
+ * retries PARK_SPIN_TRIES times (PARK_SPIN_PAUSE cycles apart) and then
+ * parks:
+ *
+ *   seq = park_prepare(p)    read seq, register as a waiter (full barrier)
+ *   re-check the structure   if not empty (or busy): park_cancel(p)
+ *   park_wait(p, seq)        futex wait, unless seq moved meanwhile
+ *
+ * A producer calls park_wake(p) after its update is visible. With no
+ * waiters this is one load and one branch. Otherwise it bumps seq and wakes
+ * one waiter, so every insertion wakes at most one consumer.
+ *
+ * The update of the producer must be ordered before its load of waiters
+ * (i.e., published with an atomic operation). If the update is published
+ * with plain stores inside a critical section, the re-check must also treat
+ * "a producer holds the lock" as not empty (the busy argument of
+ * PARK_DEQUEUE), because the producer might have read waiters before the
+ * consumer registered.
+ *
+ * park_close wakes up everyone for good: the blocking dequeues then return
+ * 0 on empty, as the non-blocking ones.
+ */
+
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sched.h>
+#if defined(__linux__)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#endif
+#include "atomic_ops_if.h"
+
+#ifndef PARK_SPIN_TRIES
+#  define PARK_SPIN_TRIES 128
+#endif
+#ifndef PARK_SPIN_PAUSE
+#  define PARK_SPIN_PAUSE 128	/* cycles between two tries */
+#endif
+
+typedef struct parking
+{
+  volatile uint32_t seq;	/* futex word: bumped by every wake-up */
+  volatile uint32_t waiters;
+  volatile uint32_t closed;
+  volatile uint32_t parks;	/* futex waits (statistics) */
+} parking_t;
+
+static inline void
+park_init(parking_t* p)
+{
+  p->seq = 0;
+  p->waiters = 0;
+  p->closed = 0;
+  p->parks = 0;
+}
+
+static inline uint32_t
+park_prepare(parking_t* p)
+{
+  uint32_t seq = p->seq;
+  FAI_U32(&p->waiters);
+  return seq;
+}
+
+static inline void
+park_cancel(parking_t* p)
+{
+  FAD_U32(&p->waiters);
+}
+
+static inline void
+park_wait(parking_t* p, uint32_t seq)
+{
+  if (!p->closed)
+    {
+      FAI_U32(&p->parks);
+#if defined(__linux__)
+      syscall(SYS_futex, &p->seq, FUTEX_WAIT_PRIVATE, seq, NULL, NULL, 0);
+#else
+      while (p->seq == seq && !p->closed)
+	{
+	  sched_yield();
+	}
+#endif
+    }
+  FAD_U32(&p->waiters);
+}
+
+static inline void
+park_wake_n(parking_t* p, int n)
+{
+  IAF_U32(&p->seq);
+#if defined(__linux__)
+  syscall(SYS_futex, &p->seq, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+#endif
+}
+
+static inline void
+park_wake(parking_t* p)
+{
+  if (__builtin_expect(p->waiters != 0, 0))
+    {
+      park_wake_n(p, 1);
+    }
+}
+
+static inline void
+park_close(parking_t* p)
+{
+  p->closed = 1;
+  park_wake_n(p, INT_MAX);	/* the increment of seq orders the store */
+}
+
+/*
+ * val = op (an expression that returns 0 on empty), spinning and then
+ * parking until op returns an element or p is closed. busy is re-checked
+ * before parking (see above; 0 if the updates are published atomically).
+ */
+#define PARK_DEQUEUE(p, val, op, busy)					\
+  {									\
+    uint32_t __tries;							\
+    for (__tries = 0; ((val) = (op)) == 0 && __tries < PARK_SPIN_TRIES; __tries++) \
+      {									\
+	cpause(PARK_SPIN_PAUSE);					\
+      }									\
+    while ((val) == 0 && !(p)->closed)					\
+      {									\
+	uint32_t __seq = park_prepare(p);				\
+	if ((busy) || ((val) = (op)) != 0)				\
+	  {								\
+	    park_cancel(p);						\
+	    PAUSE;							\
+	    continue;							\
+	  }								\
+	park_wait(p, __seq);						\
+	(val) = (op);							\
+      }									\
+  }
+
+#endif	/* _PARKING_H_ */
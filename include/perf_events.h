@@ -0,0 +1,229 @@
+/*
+ *   File: perf_events.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: per-thread hardware performance counters (perf_event_open)
+ *   perf_events.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _PERF_EVENTS_H_
+#define _PERF_EVENTS_H_
+
+/*
+ * Compile with PERF=1 to enable. Each thread opens its own counters in
+ * PE_INIT, starts them right after crossing barrier_global (PE_START) and
+ * stops them at the end of the measurement loop (PE_STOP). The per-thread
+ * values are accumulated and PE_PRINT prints totals and per-op values.
+ * PERF_RAW=<config> adds one raw, cpu-specific event (e.g., offcore or
+ * remote HITM events) to the default set.
+ */
+
+#ifndef PERF_EVENTS_ENABLE
+#  define PERF_EVENTS_ENABLE 0
+#endif
+
+#if PERF_EVENTS_ENABLE == 1 && defined(__linux__)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define PE_CACHE_READ_MISS(c)						\
+  ((c) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+enum
+  {
+    PE_CYCLES = 0,
+    PE_INSTRUCTIONS,
+    PE_LLC_MISSES,
+    PE_L1D_MISSES,
+    PE_BRANCH_MISSES,
+    PE_DTLB_MISSES,
+#if defined(PERF_EVENTS_RAW)
+    PE_RAW,
+#endif
+    PE_NUM_EVENTS
+  };
+
+typedef struct pe_event_desc
+{
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+} pe_event_desc_t;
+
+static const pe_event_desc_t pe_events[PE_NUM_EVENTS] =
+  {
+    { "cycles",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "llc-misses",   PERF_TYPE_HW_CACHE, PE_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL) },
+    { "l1d-misses",   PERF_TYPE_HW_CACHE, PE_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D) },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { "dtlb-misses",  PERF_TYPE_HW_CACHE, PE_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB) },
+#if defined(PERF_EVENTS_RAW)
+    { "raw",          PERF_TYPE_RAW,      PERF_EVENTS_RAW },
+#endif
+  };
+
+typedef struct pe_thread
+{
+  int fd[PE_NUM_EVENTS];
+  uint64_t val[PE_NUM_EVENTS];
+} pe_thread_t;
+
+extern __thread pe_thread_t __pe_thread;
+extern uint64_t __pe_total[PE_NUM_EVENTS];
+extern uint32_t __pe_failed[PE_NUM_EVENTS];
+
+static inline int
+pe_open(const pe_event_desc_t* e)
+{
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = e->type;
+  attr.config = e->config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  /* pid = 0, cpu = -1: count the calling thread on any cpu */
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static inline void
+pe_init()
+{
+  int e;
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      __pe_thread.val[e] = 0;
+      __pe_thread.fd[e] = pe_open(&pe_events[e]);
+      if (__pe_thread.fd[e] < 0)
+	{
+	  __sync_fetch_and_add(&__pe_failed[e], 1);
+	}
+    }
+}
+
+static inline void
+pe_start()
+{
+  int e;
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      if (__pe_thread.fd[e] >= 0)
+	{
+	  ioctl(__pe_thread.fd[e], PERF_EVENT_IOC_RESET, 0);
+	  ioctl(__pe_thread.fd[e], PERF_EVENT_IOC_ENABLE, 0);
+	}
+    }
+}
+
+/* stops the counters and adds the (multiplexing-scaled) values to the totals */
+static inline void
+pe_stop()
+{
+  int e;
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      if (__pe_thread.fd[e] >= 0)
+	{
+	  ioctl(__pe_thread.fd[e], PERF_EVENT_IOC_DISABLE, 0);
+	}
+    }
+
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      uint64_t v[3];		/* value, time enabled, time running */
+      if (__pe_thread.fd[e] < 0 || read(__pe_thread.fd[e], v, sizeof(v)) != sizeof(v))
+	{
+	  continue;
+	}
+      if (v[2] > 0 && v[2] < v[1])
+	{
+	  v[0] = (uint64_t) ((double) v[0] * v[1] / v[2]);
+	}
+      __pe_thread.val[e] = v[0];
+      __sync_fetch_and_add(&__pe_total[e], v[0]);
+    }
+}
+
+static inline void
+pe_term()
+{
+  int e;
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      if (__pe_thread.fd[e] >= 0)
+	{
+	  close(__pe_thread.fd[e]);
+	  __pe_thread.fd[e] = -1;
+	}
+    }
+}
+
+static inline void
+pe_print(uint64_t num_ops)
+{
+  printf("#perf  %-14s : %-16s | %s\n", "event", "total", "per op");
+  int e;
+  for (e = 0; e < PE_NUM_EVENTS; e++)
+    {
+      if (__pe_failed[e])
+	{
+	  printf("#perf  %-14s : %-16s | (could not open on %u threads)\n",
+		 pe_events[e].name, "n/a", __pe_failed[e]);
+	  continue;
+	}
+      double per_op = num_ops ? (double) __pe_total[e] / num_ops : 0;
+      printf("#perf  %-14s : %-16llu | %.3f\n", pe_events[e].name,
+	     (long long unsigned int) __pe_total[e], per_op);
+    }
+  if (!__pe_failed[PE_CYCLES] && !__pe_failed[PE_INSTRUCTIONS] && __pe_total[PE_CYCLES])
+    {
+      printf("#perf  %-14s : %.3f\n", "ipc", (double) __pe_total[PE_INSTRUCTIONS] / __pe_total[PE_CYCLES]);
+    }
+}
+
+#  define PE_VARS_DEFINITION()						\
+  __thread pe_thread_t __pe_thread;					\
+  uint64_t __pe_total[PE_NUM_EVENTS];					\
+  uint32_t __pe_failed[PE_NUM_EVENTS]
+
+#  define PE_INIT()     pe_init()
+#  define PE_START()    pe_start()
+#  define PE_STOP()     pe_stop()
+#  define PE_TERM()     pe_term()
+#  define PE_PRINT(ops) pe_print(ops)
+
+#else  /* PERF_EVENTS_ENABLE */
+
+#  define PE_VARS_DEFINITION()
+#  define PE_INIT()
+#  define PE_START()
+#  define PE_STOP()
+#  define PE_TERM()
+#  define PE_PRINT(ops)
+
+#endif	/* PERF_EVENTS_ENABLE */
+
+#endif	/* _PERF_EVENTS_H_ */
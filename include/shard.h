@@ -0,0 +1,445 @@
+/*
+ *   File: shard.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: key-space partitioning (sharding) of the tests across
+ *                independent instances of a data structure
+ *   shard.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _SHARD_H_
+#define _SHARD_H_
+
+/*
+ * With -P <n> (shards), the test uses n independent instances of the data
+ * structure and every key belongs to exactly one of them: by a hash of the
+ * key (default), or by key range with -R (shard i holds the i-th 1/n of the
+ * key range). Shard i belongs to NUMA node (socket) i * nodes / n, so the
+ * shards are spread over the nodes (with PLATFORM_NUMA; the placement is
+ * only reported otherwise): it is created while preferring the memory of the
+ * node, and the initial fill of the shard is inserted by the threads on the
+ * node (shard_fill_count), so that its nodes come from allocators of the
+ * node. A shard on a node without test threads is filled by all threads.
+ * The nodes that are inserted later come from the allocator of the
+ * inserting thread.
+ *
+ * With -L (affinity), every thread gets a home shard on the node of its cpu
+ * (after the initial fill) and maps its keys into the keys of that shard:
+ * the threads of a node only touch the memory of the node, and the threads
+ * of a shard only contend with each other.
+ *
+ * Ordered structures scan [lo, hi] across the shards with shard_scan: with
+ * range partitioning, the scans of the covering shards are concatenated;
+ * with hash partitioning, every shard holds a part of [lo, hi] and the
+ * sorted per-shard results are merged.
+ *
+ * The DS_* macros of a test call the structure on SHARD(set, key), and the
+ * functions of the whole structure (size, memory) loop over the shards.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "common.h"
+#include "topology.h"
+
+#define SHARD_MAX   64
+
+#define SHARD_HASH  0
+#define SHARD_RANGE 1
+
+/* tries to find a key of the home shard by probing the keys after a key */
+#define SHARD_PROBES 1024
+/* the keys of the hash shards are counted up to this span (estimated
+   otherwise) */
+#define SHARD_COUNT_MAX (1LL << 24)
+
+typedef void* (*shard_new_t)();
+typedef size_t (*shard_scan_t)(void* set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max);
+
+typedef struct shards
+{
+  uint32_t num;			/* 0: sharding is off */
+  uint32_t policy;
+  uint32_t affinity;
+  uint32_t nodes;
+  skey_t key_min;		/* the keys are key_min .. key_min + span - 1 */
+  skey_t span;
+  skey_t width;			/* keys per shard with SHARD_RANGE */
+  size_t fill[SHARD_MAX];	/* initial keys of every shard */
+  void* set[SHARD_MAX];
+} shards_t;
+
+extern shards_t __shards;
+extern __thread int32_t __shard_home;
+extern __thread skey_t* __shard_scan_keys;
+extern __thread sval_t* __shard_scan_vals;
+extern __thread size_t __shard_scan_size;
+
+static inline uint32_t
+shard_of(shards_t* s, skey_t key)
+{
+  if (s->policy == SHARD_RANGE)
+    {
+      if (key <= s->key_min)
+	{
+	  return 0;
+	}
+      uint64_t i = (key - s->key_min) / s->width;
+      return (i < s->num) ? i : s->num - 1;
+    }
+  /* mixed, so that the shard does not correlate with the low bits of the
+     key (e.g., the buckets of a hash table) */
+  return ((((uint64_t) key * 0x9E3779B97F4A7C15ULL) >> 32) % s->num);
+}
+
+static inline uint32_t
+shard_node(shards_t* s, uint32_t i)
+{
+  return i * s->nodes / s->num;
+}
+
+/* the node of the cpu of thread id */
+static inline uint32_t
+shard_thread_node(shards_t* s, uint32_t id)
+{
+  return topo_cpu_socket(topo_thread_cpu(id)) % s->nodes;
+}
+
+/*
+ * divides the initial keys over the shards, in proportion to the keys of
+ * every shard (so that no shard gets more keys than it has)
+ */
+static inline void
+shard_fill_init(shards_t* s, size_t initial)
+{
+  skey_t keys[SHARD_MAX];
+  uint32_t i;
+  for (i = 0; i < s->num; i++)
+    {
+      keys[i] = 0;
+    }
+
+  if (s->policy == SHARD_RANGE)
+    {
+      for (i = 0; i < s->num; i++)
+	{
+	  skey_t lo = i * s->width;
+	  skey_t hi = lo + s->width;
+	  keys[i] = (lo >= s->span) ? 0 : ((hi > s->span) ? s->span : hi) - lo;
+	}
+    }
+  else if (s->span <= SHARD_COUNT_MAX)
+    {
+      skey_t k;
+      for (k = 0; k < s->span; k++)
+	{
+	  keys[shard_of(s, s->key_min + k)]++;
+	}
+    }
+  else
+    {
+      for (i = 0; i < s->num; i++)
+	{
+	  keys[i] = s->span / s->num;
+	}
+    }
+
+  size_t assigned = 0;
+  for (i = 0; i < s->num; i++)
+    {
+      s->fill[i] = (size_t) ((double) initial * keys[i] / s->span);
+      if (s->fill[i] > (size_t) keys[i])
+	{
+	  s->fill[i] = keys[i];
+	}
+      assigned += s->fill[i];
+    }
+  while (assigned < initial)
+    {
+      size_t before = assigned;
+      for (i = 0; i < s->num && assigned < initial; i++)
+	{
+	  if (s->fill[i] < (size_t) keys[i])
+	    {
+	      s->fill[i]++;
+	      assigned++;
+	    }
+	}
+      if (assigned == before)
+	{
+	  break;
+	}
+    }
+}
+
+/*
+ * creates num shards with new_fn, every one on its node. key_min and span
+ * are the key range of the test, initial the number of initial keys.
+ */
+static inline void
+shard_init(shards_t* s, uint32_t num, uint32_t policy, uint32_t affinity, skey_t key_min, skey_t span,
+	   size_t initial, shard_new_t new_fn)
+{
+  s->num = (num > SHARD_MAX) ? SHARD_MAX : num;
+  s->policy = policy;
+  s->affinity = affinity;
+  s->nodes = topo_num_sockets();
+  s->key_min = key_min;
+  s->span = span;
+  s->width = (span + s->num - 1) / s->num;
+
+#if defined(__x86_64__) && defined(PLATFORM_NUMA)
+  int my_node = numa_preferred();
+#endif
+  uint32_t i;
+  for (i = 0; i < s->num; i++)
+    {
+#if defined(__x86_64__) && defined(PLATFORM_NUMA)
+      numa_set_preferred(shard_node(s, i));
+#endif
+      s->set[i] = new_fn();
+    }
+#if defined(__x86_64__) && defined(PLATFORM_NUMA)
+  numa_set_preferred(my_node);
+#endif
+  shard_fill_init(s, initial);
+}
+
+/*
+ * the number of initial keys that thread id (of num_threads) inserts into
+ * shard i: the fill of the shard is divided over the threads on its node,
+ * or over all threads if the node has none
+ */
+static inline size_t
+shard_fill_count(shards_t* s, uint32_t i, uint32_t id, uint32_t num_threads)
+{
+  uint32_t node = shard_node(s, i);
+  uint32_t t, fillers = 0, rank = 0, mine = 0;
+  for (t = 0; t < num_threads; t++)
+    {
+      if (shard_thread_node(s, t) == node)
+	{
+	  if (t == id)
+	    {
+	      rank = fillers;
+	      mine = 1;
+	    }
+	  fillers++;
+	}
+    }
+  if (fillers == 0)
+    {
+      fillers = num_threads;
+      rank = id;
+      mine = 1;
+    }
+  if (!mine)
+    {
+      return 0;
+    }
+  return s->fill[i] / fillers + (rank < s->fill[i] % fillers);
+}
+
+/*
+ * the home shard of thread id with -L: one of the shards on the node of its
+ * cpu (or any shard, if the node has none)
+ */
+static inline void
+shard_thread_home(shards_t* s, uint32_t id)
+{
+  if (s->num == 0 || !s->affinity)
+    {
+      return;
+    }
+
+  uint32_t node = shard_thread_node(s, id);
+  uint32_t i, on_node = 0, first = 0;
+  for (i = 0; i < s->num; i++)
+    {
+      if (shard_node(s, i) == node)
+	{
+	  if (on_node++ == 0)
+	    {
+	      first = i;
+	    }
+	}
+    }
+  __shard_home = on_node ? first + (id / s->nodes) % on_node : id % s->num;
+}
+
+/* a key of shard i, close to key (key, if no key is found) */
+static inline skey_t
+shard_key_of(shards_t* s, uint32_t i, skey_t key)
+{
+  if (s->policy == SHARD_RANGE)
+    {
+      skey_t lo = s->key_min + i * s->width;
+      skey_t hi = lo + s->width;
+      if (hi > s->key_min + s->span)
+	{
+	  hi = s->key_min + s->span;
+	}
+      return lo + (key - s->key_min) % (hi - lo);
+    }
+
+  skey_t k = key;
+  uint32_t p;
+  for (p = 0; p < SHARD_PROBES; p++)
+    {
+      if (shard_of(s, k) == i)
+	{
+	  return k;
+	}
+      k = (k + 1 - s->key_min) % s->span + s->key_min;
+    }
+  return key;
+}
+
+/* key, or a key of the home shard of the thread with -L */
+static inline skey_t
+shard_key(shards_t* s, skey_t key)
+{
+  if (likely(__shard_home < 0))
+    {
+      return key;
+    }
+  return shard_key_of(s, __shard_home, key);
+}
+
+/* the instance of key (set itself if sharding is off) */
+#define SHARD(set, key)							\
+  (__shards.num ? (__typeof__ (set)) __shards.set[shard_of(&__shards, key)] : (set))
+
+/* op(instance, key, t) of the (with -L, remapped) key */
+#define SHARD_OP(set, key, t, op)					\
+  ({ skey_t __sk = shard_key(&__shards, key); op(SHARD(set, __sk), __sk, t); })
+
+/* fn(set) summed over the shards (e.g., the size) */
+#define SHARD_SUM(set, fn)						\
+  ({									\
+    size_t __sum = 0;							\
+    if (__shards.num == 0)						\
+      {									\
+	__sum = fn(set);						\
+      }									\
+    else								\
+      {									\
+	uint32_t __i;							\
+	for (__i = 0; __i < __shards.num; __i++)			\
+	  {								\
+	    __sum += fn((__typeof__ (set)) __shards.set[__i]);		\
+	  }								\
+      }									\
+    __sum;								\
+  })
+
+static inline void
+shard_scan_reserve(size_t size)
+{
+  if (__shard_scan_size < size)
+    {
+      __shard_scan_keys = (skey_t*) realloc(__shard_scan_keys, size * sizeof(skey_t));
+      __shard_scan_vals = (sval_t*) realloc(__shard_scan_vals, size * sizeof(sval_t));
+      assert(__shard_scan_keys != NULL && __shard_scan_vals != NULL);
+      __shard_scan_size = size;
+    }
+}
+
+/*
+ * the (at most max) keys in [lo, hi] of all the shards, in order, with the
+ * scan function of one shard. As consistent as the per-shard scans (i.e.,
+ * weakly).
+ */
+static inline size_t
+shard_scan(shards_t* s, void* set, shard_scan_t scan, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals,
+	   size_t max)
+{
+  if (s->num == 0)
+    {
+      return scan(set, lo, hi, keys, vals, max);
+    }
+
+  uint32_t i;
+  size_t n = 0;
+  if (s->policy == SHARD_RANGE)
+    {
+      uint32_t last = shard_of(s, hi);
+      for (i = shard_of(s, lo); i <= last && n < max; i++)
+	{
+	  n += scan(s->set[i], lo, hi, keys + n, vals + n, max - n);
+	}
+      return n;
+    }
+
+  /* every shard might hold all of the first max keys */
+  size_t got[SHARD_MAX], at[SHARD_MAX];
+  shard_scan_reserve(s->num * max);
+  for (i = 0; i < s->num; i++)
+    {
+      got[i] = scan(s->set[i], lo, hi, __shard_scan_keys + i * max, __shard_scan_vals + i * max, max);
+      at[i] = 0;
+    }
+
+  while (n < max)
+    {
+      int32_t min = -1;
+      for (i = 0; i < s->num; i++)
+	{
+	  if (at[i] < got[i]
+	      && (min < 0 || __shard_scan_keys[i * max + at[i]] < __shard_scan_keys[min * max + at[min]]))
+	    {
+	      min = i;
+	    }
+	}
+      if (min < 0)
+	{
+	  break;
+	}
+      keys[n] = __shard_scan_keys[min * max + at[min]];
+      vals[n] = __shard_scan_vals[min * max + at[min]];
+      at[min]++;
+      n++;
+    }
+  return n;
+}
+
+static inline void
+shard_print(shards_t* s)
+{
+  if (s->num == 0)
+    {
+      return;
+    }
+
+  printf("#shards: %u (%s partitioning%s) over %u nodes", s->num,
+	 (s->policy == SHARD_RANGE) ? "range" : "hash", s->affinity ? ", thread affinity" : "", s->nodes);
+#if !defined(PLATFORM_NUMA)
+  printf(" (placement not enforced: no PLATFORM_NUMA)");
+#endif
+  printf("\n");
+}
+
+#define SHARD_VARS_DEFINITION()						\
+  shards_t __shards;							\
+  __thread int32_t __shard_home = -1;					\
+  __thread skey_t* __shard_scan_keys = NULL;				\
+  __thread sval_t* __shard_scan_vals = NULL;				\
+  __thread size_t __shard_scan_size = 0
+
+#endif	/* _SHARD_H_ */
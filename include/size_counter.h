@@ -0,0 +1,137 @@
+/*
+ *   File: size_counter.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: approximate O(threads) size with per-thread delta counters
+ *   size_counter.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _SIZE_COUNTER_H_
+#define _SIZE_COUNTER_H_
+
+/*
+ * With SIZE_COUNTERS == 1 (make SIZE_COUNTERS=1), a data structure keeps one
+ * padded counter per thread, which the thread increments (decrements) after
+ * a successful insert (remove). The size is the sum of the counters of the
+ * threads that have updated the structure, so reading it costs O(threads)
+ * instead of a traversal. The sum is exact when there are no concurrent
+ * updates; otherwise it is off by at most the number of in-flight updates.
+ *
+ * Threads get a counter index on their first update. Beyond
+ * SIZE_COUNTER_MAX_THREADS threads, thread i shares the counter of thread
+ * i % SIZE_COUNTER_MAX_THREADS, so all the updates are atomic (a locked add
+ * on a line that is private to the thread in the common case). Without
+ * SIZE_COUNTERS, the counters are not allocated, the updates compile away,
+ * and the *_size_approx functions traverse.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <malloc.h>
+
+#ifndef SIZE_COUNTERS
+#  define SIZE_COUNTERS 0
+#endif
+
+#ifndef CACHE_LINE_SIZE
+#  define CACHE_LINE_SIZE 64
+#endif
+
+#define SIZE_COUNTER_MAX_THREADS 256
+
+typedef struct size_counter
+{
+  volatile int64_t delta;
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(int64_t)];
+} size_counter_t;
+
+#if SIZE_COUNTERS == 1
+
+extern __thread int32_t __size_counter_id;
+extern volatile uint32_t __size_counter_num;
+
+static inline size_counter_t*
+size_counter_new()
+{
+  size_t bytes = SIZE_COUNTER_MAX_THREADS * sizeof(size_counter_t);
+  size_counter_t* sc = (size_counter_t*) memalign(CACHE_LINE_SIZE, bytes);
+  if (sc == NULL)
+    {
+      perror("memalign size counters");
+      exit(1);
+    }
+  memset(sc, 0, bytes);
+  return sc;
+}
+
+static inline void
+size_counter_free(size_counter_t* sc)
+{
+  free(sc);
+}
+
+static inline void
+size_counter_add(size_counter_t* sc, int64_t d)
+{
+  if (__builtin_expect(__size_counter_id < 0, 0))
+    {
+      __size_counter_id = __sync_fetch_and_add(&__size_counter_num, 1);
+    }
+
+  /* any counter can be shared once there are more threads than counters */
+  __sync_fetch_and_add(&sc[__size_counter_id % SIZE_COUNTER_MAX_THREADS].delta, d);
+}
+
+static inline size_t
+size_counter_read(size_counter_t* sc)
+{
+  uint32_t n = __size_counter_num;
+  if (n > SIZE_COUNTER_MAX_THREADS)
+    {
+      n = SIZE_COUNTER_MAX_THREADS;
+    }
+
+  int64_t size = 0;
+  uint32_t i;
+  for (i = 0; i < n; i++)
+    {
+      size += sc[i].delta;
+    }
+  return (size > 0) ? (size_t) size : 0;
+}
+
+#  define SIZE_COUNTER_NEW()          size_counter_new()
+#  define SIZE_COUNTER_FREE(sc)       size_counter_free(sc)
+#  define SIZE_COUNTER_INC(sc, ok)    do { if (ok) { size_counter_add(sc, 1); } } while (0)
+#  define SIZE_COUNTER_DEC(sc, ok)    do { if (ok) { size_counter_add(sc, -1); } } while (0)
+#  define SIZE_COUNTER_VARS_DEFINITION()				\
+  __thread int32_t __size_counter_id = -1;				\
+  volatile uint32_t __size_counter_num = 0
+
+#else  /* SIZE_COUNTERS != 1 */
+
+#  define SIZE_COUNTER_NEW()          NULL
+#  define SIZE_COUNTER_FREE(sc)
+#  define SIZE_COUNTER_INC(sc, ok)    do { } while (0)
+#  define SIZE_COUNTER_DEC(sc, ok)    do { } while (0)
+#  define SIZE_COUNTER_VARS_DEFINITION()
+
+#endif	/* SIZE_COUNTERS */
+
+#endif	/* _SIZE_COUNTER_H_ */
@@ -38,7 +38,7 @@
 #include <string.h>
 
 #if GC >= 1			/* don't even allocate ssalloc if we have ssmem 
-				 or if GC==2 */
+				 or if GC==2 or GC==3 */
 #  define SSALLOC_USE_MALLOC
 #endif
 
@@ -0,0 +1,375 @@
+/*
+ *   File: topology.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: runtime cpu topology detection and thread placement policies
+ *   topology.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _TOPOLOGY_H_
+#define _TOPOLOGY_H_
+
+/*
+ * The topology (socket, core, and hw context of every cpu) is read once from
+ * /sys/devices/system/cpu, restricted to the cpus the process may run on.
+ * The cpus are then ordered according to a placement policy, so that thread
+ * i is placed on order[i]:
+ *
+ *   default      : the os order of the cpus
+ *   compact      : fill the hw contexts of a core, then the cores of a socket
+ *   scatter      : round-robin across sockets, one hw context per core first
+ *   socket-first : fill a socket (one context per core, then the siblings)
+ *                  before moving to the next socket
+ *   smt-last     : one context per core, socket after socket, and only then
+ *                  the smt siblings
+ *
+ * The policy is selected per run with the ASCYLIB_PLACEMENT environment
+ * variable. The first call (set_cpu(0) in the harnesses) must happen before
+ * any thread is pinned, otherwise only the pinned cpu is visible.
+ *
+ * With ASCYLIB_CPUS=<m>, the tests only use the first m cpus of the order
+ * and pin every thread, also the ones beyond m: thread i runs on order[i % m]
+ * (oversubscription, e.g., 4 threads per cpu with -n16 on 4 cpus). The
+ * threads of a cpu are time-sliced by the os, so lock holders and waiters
+ * get preempted as with more threads than cores in production. Without it,
+ * the threads beyond the number of cpus are not pinned.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define TOPO_MAX_CPUS    1024
+#define TOPO_MAX_SOCKETS 8
+#define TOPO_SYSFS       "/sys/devices/system/cpu"
+#define TOPO_ENV         "ASCYLIB_PLACEMENT"
+#define TOPO_ENV_CPUS    "ASCYLIB_CPUS"
+
+typedef enum
+  {
+    TOPO_PLACE_DEFAULT = 0,
+    TOPO_PLACE_COMPACT,
+    TOPO_PLACE_SCATTER,
+    TOPO_PLACE_SOCKET_FIRST,
+    TOPO_PLACE_SMT_LAST,
+  } topo_placement_t;
+
+static const char* __attribute__ ((unused)) topo_placement_names[] =
+  {
+    "default", "compact", "scatter", "socket-first", "smt-last"
+  };
+
+typedef struct topo_cpu
+{
+  int16_t cpu;
+  int16_t socket;		/* dense index of the physical package */
+  int16_t core;			/* dense index of the core within the socket */
+  int16_t smt;			/* index of the hw context within the core */
+} topo_cpu_t;
+
+typedef struct topology
+{
+  uint32_t num_cpus;
+  uint32_t num_sockets;
+  topo_placement_t placement;
+  uint32_t pin_all;		/* ASCYLIB_CPUS: pin the threads beyond num_cpus too */
+  int16_t socket_of[TOPO_MAX_CPUS]; /* by os cpu id */
+  topo_cpu_t order[TOPO_MAX_CPUS];  /* by thread id */
+} topology_t;
+
+extern topology_t __topo;
+extern pthread_once_t __topo_once;
+
+static inline int
+topo_read_int(const char* file, int cpu, int* val)
+{
+  char path[128];
+  snprintf(path, sizeof(path), TOPO_SYSFS "/cpu%d/topology/%s", cpu, file);
+  FILE* f = fopen(path, "r");
+  if (f == NULL)
+    {
+      return 0;
+    }
+  int ok = (fscanf(f, "%d", val) == 1);
+  fclose(f);
+  return ok;
+}
+
+/* parses a cpu list such as "0-7,16-23" into the mask */
+static inline int
+topo_read_online(cpu_set_t* online)
+{
+  FILE* f = fopen(TOPO_SYSFS "/online", "r");
+  if (f == NULL)
+    {
+      return 0;
+    }
+
+  CPU_ZERO(online);
+  int n = 0, lo, hi;
+  while (fscanf(f, "%d", &lo) == 1)
+    {
+      hi = lo;
+      int c = fgetc(f);
+      if (c == '-')
+	{
+	  if (fscanf(f, "%d", &hi) != 1)
+	    {
+	      break;
+	    }
+	  c = fgetc(f);
+	}
+      for (; lo <= hi && lo < TOPO_MAX_CPUS; lo++)
+	{
+	  CPU_SET(lo, online);
+	  n++;
+	}
+      if (c != ',')
+	{
+	  break;
+	}
+    }
+  fclose(f);
+  return n;
+}
+
+static inline topo_placement_t
+topo_parse_placement(const char* s)
+{
+  int p;
+  for (p = 0; p <= TOPO_PLACE_SMT_LAST; p++)
+    {
+      if (!strcmp(s, topo_placement_names[p]))
+	{
+	  return (topo_placement_t) p;
+	}
+    }
+  fprintf(stderr, "** unknown %s=%s (default, compact, scatter, socket-first, smt-last)\n",
+	  TOPO_ENV, s);
+  return TOPO_PLACE_DEFAULT;
+}
+
+/* the sort keys of each policy, most significant first */
+static inline void
+topo_keys(const topo_cpu_t* c, int k[4])
+{
+  switch (__topo.placement)
+    {
+    case TOPO_PLACE_COMPACT:
+      k[0] = c->socket; k[1] = c->core; k[2] = c->smt; break;
+    case TOPO_PLACE_SCATTER:
+      k[0] = c->smt; k[1] = c->core; k[2] = c->socket; break;
+    case TOPO_PLACE_SOCKET_FIRST:
+      k[0] = c->socket; k[1] = c->smt; k[2] = c->core; break;
+    case TOPO_PLACE_SMT_LAST:
+      k[0] = c->smt; k[1] = c->socket; k[2] = c->core; break;
+    default:
+      k[0] = k[1] = k[2] = 0; break;
+    }
+  k[3] = c->cpu;
+}
+
+static inline int
+topo_cmp(const void* a, const void* b)
+{
+  int ka[4], kb[4], i;
+  topo_keys((const topo_cpu_t*) a, ka);
+  topo_keys((const topo_cpu_t*) b, kb);
+  for (i = 0; i < 4; i++)
+    {
+      if (ka[i] != kb[i])
+	{
+	  return ka[i] - kb[i];
+	}
+    }
+  return 0;
+}
+
+static inline void
+topo_init()
+{
+  topology_t* t = &__topo;
+  cpu_set_t online, allowed;
+  int c, i, j;
+
+  if (!topo_read_online(&online))
+    {
+      CPU_ZERO(&online);
+      int n = sysconf(_SC_NPROCESSORS_ONLN);
+      for (c = 0; c < n && c < TOPO_MAX_CPUS; c++)
+	{
+	  CPU_SET(c, &online);
+	}
+    }
+
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+    {
+      cpu_set_t both;
+      CPU_AND(&both, &online, &allowed);
+      if (CPU_COUNT(&both) > 0)
+	{
+	  online = both;
+	}
+    }
+
+  int pkg[TOPO_MAX_CPUS], core_id[TOPO_MAX_CPUS];
+  int pkgs[TOPO_MAX_CPUS], num_pkgs = 0;
+  t->num_cpus = 0;
+  for (c = 0; c < TOPO_MAX_CPUS && c < CPU_SETSIZE; c++)
+    {
+      t->socket_of[c] = 0;
+      if (!CPU_ISSET(c, &online))
+	{
+	  continue;
+	}
+
+      i = t->num_cpus++;
+      t->order[i].cpu = c;
+      if (!topo_read_int("physical_package_id", c, &pkg[i]) || pkg[i] < 0)
+	{
+	  pkg[i] = 0;
+	}
+      if (!topo_read_int("core_id", c, &core_id[i]))
+	{
+	  core_id[i] = c;
+	}
+
+      for (j = 0; j < num_pkgs && pkgs[j] != pkg[i]; j++);
+      if (j == num_pkgs)
+	{
+	  pkgs[num_pkgs++] = pkg[i];
+	}
+    }
+
+  /* dense socket ids, in the order of the package ids */
+  for (i = 0; i < (int) t->num_cpus; i++)
+    {
+      int s = 0;
+      for (j = 0; j < num_pkgs; j++)
+	{
+	  s += (pkgs[j] < pkg[i]);
+	}
+      t->order[i].socket = s;
+      t->socket_of[t->order[i].cpu] = s;
+    }
+  t->num_sockets = num_pkgs;
+
+  /* dense core ids within the socket; smt index among the cpus of a core */
+  int first[TOPO_MAX_CPUS];
+  for (i = 0; i < (int) t->num_cpus; i++)
+    {
+      int smt = 0;
+      for (j = 0; j < i; j++)
+	{
+	  smt += (pkg[j] == pkg[i] && core_id[j] == core_id[i]);
+	}
+      t->order[i].smt = smt;
+      first[i] = (smt == 0);
+    }
+  for (i = 0; i < (int) t->num_cpus; i++)
+    {
+      int core = 0;
+      for (j = 0; j < (int) t->num_cpus; j++)
+	{
+	  core += (first[j] && pkg[j] == pkg[i] && core_id[j] < core_id[i]);
+	}
+      t->order[i].core = core;
+    }
+
+  const char* env = getenv(TOPO_ENV);
+  t->placement = (env != NULL && *env) ? topo_parse_placement(env) : TOPO_PLACE_DEFAULT;
+  if (t->placement != TOPO_PLACE_DEFAULT)
+    {
+      qsort(t->order, t->num_cpus, sizeof(topo_cpu_t), topo_cmp);
+      printf("## placement: %s (%u cpus on %u sockets)\n", topo_placement_names[t->placement],
+	     t->num_cpus, t->num_sockets);
+    }
+
+  env = getenv(TOPO_ENV_CPUS);
+  int cpus = (env != NULL && *env) ? atoi(env) : 0;
+  t->pin_all = (cpus > 0);
+  if (t->pin_all)
+    {
+      if ((uint32_t) cpus < t->num_cpus)
+	{
+	  t->num_cpus = cpus;
+	}
+      printf("## cpus: %u (the threads are pinned round-robin on them)\n", t->num_cpus);
+    }
+}
+
+static inline topology_t*
+topo_get()
+{
+  pthread_once(&__topo_once, topo_init);
+  return &__topo;
+}
+
+static inline uint32_t
+topo_num_cpus()
+{
+  return topo_get()->num_cpus;
+}
+
+static inline uint32_t
+topo_num_sockets()
+{
+  return topo_get()->num_sockets;
+}
+
+/* was a placement policy (or a number of cpus) requested for this run? */
+static inline int
+topo_has_placement()
+{
+  topology_t* t = topo_get();
+  return t->placement != TOPO_PLACE_DEFAULT || t->pin_all;
+}
+
+/* are the threads beyond the number of cpus pinned (ASCYLIB_CPUS)? */
+static inline int
+topo_pin_all()
+{
+  return topo_get()->pin_all;
+}
+
+/* the os cpu of thread id (thread ids beyond the number of cpus wrap around) */
+static inline int
+topo_thread_cpu(uint32_t id)
+{
+  topology_t* t = topo_get();
+  return t->order[id % t->num_cpus].cpu;
+}
+
+static inline int
+topo_cpu_socket(int cpu)
+{
+  if (cpu < 0 || cpu >= TOPO_MAX_CPUS)
+    {
+      return 0;
+    }
+  return topo_get()->socket_of[cpu];
+}
+
+#define TOPO_VARS_DEFINITION()					\
+  topology_t __topo;						\
+  pthread_once_t __topo_once = PTHREAD_ONCE_INIT
+
+#endif	/* _TOPOLOGY_H_ */
@@ -42,6 +42,11 @@
 #include "getticks.h"
 #include "random.h"
 #include "measurements.h"
+#include "perf_events.h"
+#include "topology.h"
+#include "mem_stats.h"
+#include "huge_pages.h"
+#include "backoff.h"
 #include "ssalloc.h"
 #include "atomic_ops_if.h"
 
@@ -710,6 +715,36 @@ static __attribute__ ((unused)) double eng_per_test_iter_nj[40][5] =
 #endif
   }
 
+  /*
+   * Without a manual platform entry, or when a placement policy is given in
+   * ASCYLIB_PLACEMENT, the threads are placed and the sockets are found with
+   * the topology detected at runtime (topology.h) instead of the_cores.
+   */
+  static inline int use_topology()
+  {
+#if defined(DEFAULT)
+    return 1;
+#else
+    return topo_has_placement();
+#endif
+  }
+
+  /* socket of the os cpu cpu */
+  static inline int get_cpu_socket(int cpu) {
+    if (use_topology())
+      {
+	return topo_cpu_socket(cpu);
+      }
+    return get_cluster(cpu);
+  }
+
+  /* number of sockets the hierarchical locks keep a local lock for */
+#if defined(DEFAULT)
+#  define NUMBER_OF_LOCK_SOCKETS TOPO_MAX_SOCKETS
+#else
+#  define NUMBER_OF_LOCK_SOCKETS NUMBER_OF_SOCKETS
+#endif
+
   static inline double wtime(void)
   {
     struct timeval t;
@@ -735,14 +770,19 @@ static __attribute__ ((unused)) double eng_per_test_iter_nj[40][5] =
 
     int n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
     //    cpu %= (NUMBER_OF_SOCKETS * CORES_PER_SOCKET);
-    if (cpu < n_cpus)
+    int use_topo = use_topology();
+    if (use_topo)
       {
-	int cpu_use = the_cores[cpu];
+	n_cpus = topo_num_cpus();
+      }
+    if (cpu < n_cpus || (use_topo && topo_pin_all()))
+      {
+	int cpu_use = use_topo ? topo_thread_cpu(cpu) : the_cores[cpu];
 	cpu_set_t mask;
 	CPU_ZERO(&mask);
 	CPU_SET(cpu_use, &mask);
 #    if defined(PLATFORM_NUMA)
-	numa_set_preferred(get_cluster(cpu_use));
+	numa_set_preferred(get_cpu_socket(cpu_use));
 #    endif
 	pthread_t thread = pthread_self();
 	if (pthread_setaffinity_np(thread, sizeof(cpu_set_t), &mask) != 0) 
@@ -844,20 +884,52 @@ static __attribute__ ((unused)) double eng_per_test_iter_nj[40][5] =
     cdelay(tp);
   }
 
-#define DO_PAUSE_TYPE         1       // 0: fixed max pause
-                                      // 1: exponentially increasing pause
+  /* see backoff.h */
+  static inline void
+  do_pause_adaptive(size_t nf)
+  {
+    backoff_t* b = &__backoff;
+    b->retries++;
+    if (unlikely(nf > 16))
+      {
+	nf = 16;
+      }
+    size_t w = ((size_t) __backoff_unit * (BACKOFF_AVG_ONE + b->avg)) / BACKOFF_AVG_ONE;
+    w <<= nf;
+    if (w > pause_max)
+      {
+	w = pause_max;
+      }
+    const size_t tp = (w >> 1) + (mrand(seeds) % ((w >> 1) + 1));
+#if RETRY_STATS == 1
+    b->pauses++;
+    b->cycles += tp;
+#endif
+    cdelay(tp);
+  }
 
+/* DO_PAUSE_TYPE (backoff.h, make BACKOFF=fixed|exp|adaptive)
+   0: fixed max pause
+   1: exponentially increasing pause
+   2: contention-adaptive pause (default) */
 
 #if DO_PAUSE_TYPE == 0
 #define DO_PAUSE()            do_pause()
 #define NUM_RETRIES()        
+#define BACKOFF_QUEUED(d)     ((d) << 8)
 #elif DO_PAUSE_TYPE == 1
 #define DO_PAUSE()            do_pause_exp(__nr++);
-#define NUM_RETRIES()         UNUSED size_t __nr;
+#define NUM_RETRIES()         UNUSED size_t __nr = 0;
+#define BACKOFF_QUEUED(d)     ((d) << 8)
 #else
-
+#define DO_PAUSE()            do_pause_adaptive(__nr++);
+#define NUM_RETRIES()         UNUSED size_t __nr = backoff_op_start();
+  /* pause of a thread with d threads before it in a lock queue */
+#define BACKOFF_QUEUED(d)     ((d) * __backoff_unit)
 #endif
 
+#include "size_counter.h"
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,74 @@
+#!/bin/bash
+
+## Preemption tolerance: runs the stack and the queue protected with spin
+## locks (TAS, TICKET, MCS, CLH), with OPTIK, and lock-free, with k threads
+## per cpu on the first m cpus (ASCYLIB_CPUS=m, see include/topology.h), so
+## that the os preempts lock holders and waiters. Prints the throughput for
+## every k, and the throughput with the most threads over the one with a
+## thread per cpu (the collapse: 1 means no loss).
+##
+## usage: ./scripts/run_oversubscription.sh [build] [cpus] [threads per cpu] [test options]
+##   build: first compiles the lock-based variants into ./bin/*_<lock>
+##   e.g. ./scripts/run_oversubscription.sh build 4 "1 2 4 8" -d2000
+
+locks="tas ticket mcs clh";
+
+if [ "$1" = "build" ];
+then
+    shift;
+    for lock in $locks
+    do
+	make "LOCK=$(echo $lock | tr a-z A-Z)" src/stack-lock src/queue-ms_lb || exit 1;
+	mv ./bin/lb-st_lock ./bin/lb-st_lock_$lock;
+	mv ./bin/lb-qu_ms ./bin/lb-qu_ms_$lock;
+    done;
+    make lbst_optik lbqu_optik1 lfst_treiber lfqu_ms || exit 1;
+fi;
+
+cpus=${1:-$(nproc)};
+per_cpu_all=${2:-"1 2 4 8"};
+[ $# -gt 0 ] && shift;
+[ $# -gt 0 ] && shift;
+settings="-d1000 $@";
+
+bins="";
+for lock in $locks
+do
+    bins="$bins ./bin/lb-st_lock_$lock";
+done;
+bins="$bins ./bin/lb-st_optik ./bin/lf-st_treiber";
+for lock in $locks
+do
+    bins="$bins ./bin/lb-qu_ms_$lock";
+done;
+bins="$bins ./bin/lb-qu_optik1 ./bin/lf-qu_ms";
+
+echo "## cpus: $cpus / threads per cpu: $per_cpu_all / settings: $settings";
+printf "%-22s" "#executable";
+for k in $per_cpu_all
+do
+    printf "%-10s" "x$k(Mops)";
+done;
+printf "%s\n" "collapse";
+
+for bin in $bins
+do
+    if [ ! -x $bin ];
+    then
+	echo "## $bin is missing (run with build first)";
+	continue;
+    fi;
+
+    printf "%-22s" $(basename $bin);
+    first="";
+    last="";
+    for k in $per_cpu_all
+    do
+	n=$(($cpus * $k));
+	mops=$(ASCYLIB_CPUS=$cpus $bin -n$n $settings | awk '/^#Mops/ { print $2 }');
+	printf "%-10s" $mops;
+	[ -z "$first" ] && first=$mops;
+	last=$mops;
+    done;
+    echo "$first $last" | awk '{ if ($1 > 0) printf("%.2f\n", $2 / $1); else printf("-\n"); }';
+done;
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+## Compares the memory reclamation of the lock-free lists: ssmem (make lfll,
+## ./bin/lf-ll_*) vs. hazard pointers (make lfll_hp, ./bin/lf-ll_*_hp), with
+## more threads than cores and, optionally, the last thread stalled (-S).
+## Prints the throughput, the memory handed out by the allocators (the peak
+## footprint, as freed nodes are reused), and the freed nodes still waiting
+## for reclamation at the end.
+##
+## usage: ./scripts/run_reclamation.sh [threads] [stall ms] [test options]
+##   e.g. ./scripts/run_reclamation.sh "4 16 64" 1000 -i1024 -u20
+
+cores=$(nproc);
+threads_all=${1:-"$cores $((4*$cores)) $((16*$cores))"};
+stall=${2:-0};
+[ $# -gt 0 ] && shift;
+[ $# -gt 0 ] && shift;
+settings="-d2000 -i1024 -u20 $@";
+lists="harris harris_opt michael";
+
+echo "## cores: $cores / threads: $threads_all / stall: $stall ms / settings: $settings";
+printf "%-12s %-6s %-8s %-10s %-10s %s\n" "#list" "gc" "threads" "Mops" "used(MB)" "pending(objs)";
+
+for list in $lists
+do
+    for gc in ssmem hp
+    do
+	bin=./bin/lf-ll_$list;
+	if [ "$gc" = "hp" ];
+	then
+	    bin=${bin}_hp;
+	fi;
+	if [ ! -x $bin ];
+	then
+	    echo "## $bin is missing (make lfll lfll_hp)";
+	    continue;
+	fi;
+
+	for n in $threads_all
+	do
+	    out=$($bin -n$n -S$stall $settings);
+	    mops=$(echo "$out" | awk '/^#Mops/ { print $2 }');
+	    used=$(echo "$out" | awk '/^#memory used/ { print $4 }');
+	    pending=$(echo "$out" | awk '/^#memory pending/ { print $4 }');
+	    printf "%-12s %-6s %-8s %-10s %-10s %s\n" $list $gc $n $mops $used $pending;
+	done;
+    done;
+done;
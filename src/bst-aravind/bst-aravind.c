@@ -299,4 +299,10 @@ uint32_t bst_size(volatile node_t* node) {
     return l+r;
 }
 
+/* bytes of all the nodes reachable from node (including the ones being removed) */
+size_t bst_memory(volatile node_t* node) {
+    if (node == NULL) return 0;
+    return sizeof(node_t) + bst_memory(ADDRESS(node->left)) + bst_memory(ADDRESS(node->right));
+}
+
 
@@ -100,6 +100,7 @@ bool_t bst_insert(skey_t key, sval_t val, node_t* node_r);
 sval_t bst_remove(skey_t key, node_t* node_r);
 bool_t bst_cleanup(skey_t key);
 uint32_t bst_size(volatile node_t* r);
+size_t bst_memory(volatile node_t* r);
 
 static inline uint64_t GETFLAG(volatile node_t* ptr) {
     return ((uint64_t)ptr) & 1;
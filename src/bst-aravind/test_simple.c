@@ -63,6 +63,7 @@
 
 #define DS_TYPE             node_t
 #define DS_NODE             node_t
+#define DS_MEMORY(s)        bst_memory(s)
 #define DS_KEY              skey_t
 
 
@@ -84,6 +85,7 @@ size_t put, put_explicit = false;
 double update_rate, put_rate, get_rate;
 
 size_t size_after = 0;
+size_t memory_after = 0;
 int seed = 0;
 __thread unsigned long * seeds;
 uint32_t rand_max;
@@ -165,6 +167,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
     
 
@@ -208,7 +211,10 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -216,6 +222,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -223,6 +230,7 @@ test(void* thread)
   if (!ID)
     {
       size_after = DS_SIZE(set);
+      memory_after = DS_MEMORY(set);
       printf("#AFTER  size is: %zu\n", size_after);
     }
 
@@ -252,7 +260,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -278,6 +288,7 @@ main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"stall",                     required_argument, NULL, 'S'},
     {NULL, 0, NULL, 0}
   };
 
@@ -285,7 +296,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:p:b:v:f:S:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -326,6 +337,8 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -353,6 +366,9 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -558,6 +574,8 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(memory_after, size_after, sizeof(DS_NODE));
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();    
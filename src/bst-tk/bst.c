@@ -49,8 +49,19 @@ new_node(skey_t key, sval_t val, node_t* l, node_t* r, int initializing)
     }
 
   node->key = key;
+#if BST_TK_COMPACT == 1
+  if (l == NULL)
+    {
+      node->val = val;
+    }
+  else
+    {
+      node->left = l;
+    }
+#else
   node->val = val;
   node->left = l;
+#endif
   node->right = r;
   node->lock.to_uint64 = 0;
 
@@ -92,7 +103,8 @@ intset_t* set_new()
 
   node_t* min = new_node(INT_MIN, 1, NULL, NULL, 1);
   node_t* max = new_node(INT_MAX, 1, NULL, NULL, 1);
-  set->head = new_node(INT_MAX, 0, min, max, 1);
+  set->head = new_node(INT_MAX, 0, NODE_LEAF_PTR(min), NODE_LEAF_PTR(max), 1);
+  set->sizes = SIZE_COUNTER_NEW();
   MEM_BARRIER;
   return set;
 }
@@ -114,14 +126,15 @@ set_delete_l(intset_t *set)
 }
 
 static int
-node_size(node_t* n)
+node_size(node_t* p)
 {
- if (n->leaf != 0)
+ if (NODE_IS_LEAF_PTR(p))
     {
       return 1;
     }
   else
     {
+      node_t* n = NODE_PTR(p);
       return node_size((node_t*) n->left) + node_size((node_t*) n->right);
     }
 }
@@ -133,6 +146,65 @@ set_size(intset_t* set)
   return size;
 }
 
+/* O(threads) with SIZE_COUNTERS (see size_counter.h), a traversal otherwise */
+size_t
+set_size_approx(intset_t* set)
+{
+#if SIZE_COUNTERS == 1
+  return size_counter_read(set->sizes);
+#else
+  return set_size(set);
+#endif
+}
+
 
 
 	
+
+static void
+node_count(node_t* p, size_t* internal, size_t* leaves)
+{
+  if (NODE_IS_LEAF_PTR(p))
+    {
+      (*leaves)++;
+    }
+  else
+    {
+      node_t* n = NODE_PTR(p);
+      (*internal)++;
+      node_count((node_t*) n->left, internal, leaves);
+      node_count((node_t*) n->right, internal, leaves);
+    }
+}
+
+/* bytes of the set and all the nodes (internal nodes and leaves have the same size) */
+size_t
+set_memory(intset_t* set)
+{
+  size_t internal = 0, leaves = 0;
+  node_count(set->head, &internal, &leaves);
+  return sizeof(intset_t) + (internal + leaves) * sizeof(node_t);
+}
+
+/* bytes per node type; the used bytes exclude padding and unused fields */
+void
+set_print_footprint(intset_t* set)
+{
+  size_t internal = 0, leaves = 0;
+  node_count(set->head, &internal, &leaves);
+  size_t keys = leaves - 2;
+  const size_t leaf_used = sizeof(skey_t) + sizeof(sval_t);
+#if BST_TK_COMPACT == 1
+  const size_t internal_used = sizeof(skey_t) + 2 * sizeof(node_t*) + sizeof(tl_t);
+#else
+  const size_t internal_used = sizeof(skey_t) + sizeof(uint64_t) + 2 * sizeof(node_t*) + sizeof(tl_t);
+#endif
+
+  double mb = 1024.0 * 1024.0;
+  printf("#memory %-8s : %-10zu nodes x %zu B (%zu B used) = %.2f MB\n", "internal", internal,
+	 sizeof(node_t), internal_used, internal * sizeof(node_t) / mb);
+  printf("#memory %-8s : %-10zu nodes x %zu B (%zu B used) = %.2f MB\n", "leaf", leaves,
+	 sizeof(node_t), leaf_used, leaves * sizeof(node_t) / mb);
+  printf("#memory %-8s : %.2f MB / %.1f B per key\n", "total", (internal + leaves) * sizeof(node_t) / mb,
+	 keys ? (double) (internal + leaves) * sizeof(node_t) / keys : 0.0);
+}
@@ -46,6 +46,10 @@
 static volatile int stop;
 extern __thread ssmem_allocator_t* alloc;
 
+#ifndef BST_TK_COMPACT
+#  define BST_TK_COMPACT 0
+#endif
+
 
 typedef union tl32
 {
@@ -128,6 +132,33 @@ tl_revert(volatile tl_t* tl, int right)
 }
 
 
+#if BST_TK_COMPACT == 1
+/*
+ * Compact layout: a node is a single 32-byte slot. Internal nodes hold the
+ * key, both children, and the lock; leaves only use the key and the value.
+ * Leaves are recognized by a tag bit on the child pointer, so the search
+ * does not need to read a leaf flag in the child. An insert allocates the
+ * new internal node and the new leaf one after the other from the per-thread
+ * allocator, so they are adjacent in memory (in the same cache line if the
+ * internal node is aligned) when no freed slots are reused.
+ */
+typedef struct node
+{
+  skey_t key;
+  union
+  {
+    sval_t val;			/* leaves */
+    volatile struct node* left;	/* internal nodes */
+  };
+  volatile struct node* right;
+  volatile tl_t lock;
+} node_t;
+
+#  define BST_TK_LEAF_TAG          ((uintptr_t) 0x1)
+#  define NODE_IS_LEAF_PTR(p)      ((uintptr_t) (p) & BST_TK_LEAF_TAG)
+#  define NODE_PTR(p)              ((node_t*) ((uintptr_t) (p) & ~BST_TK_LEAF_TAG))
+#  define NODE_LEAF_PTR(n)         ((node_t*) ((uintptr_t) (n) | BST_TK_LEAF_TAG))
+#else
 typedef struct node
 {
   skey_t key;
@@ -143,9 +174,16 @@ typedef struct node
   uint8_t padding[CACHE_LINE_SIZE - 40];
 } node_t;
 
+/* a child pointer p points to a leaf (reads the child) */
+#  define NODE_IS_LEAF_PTR(p)      (((node_t*) (p))->leaf)
+#  define NODE_PTR(p)              ((node_t*) (p))
+#  define NODE_LEAF_PTR(n)         (n)
+#endif	/* BST_TK_COMPACT */
+
 typedef ALIGNED(CACHE_LINE_SIZE) struct intset
 {
   node_t* head;
+  size_counter_t* sizes;	/* with SIZE_COUNTERS */
 } intset_t;
 
 node_t* new_node(skey_t key, sval_t val, node_t* l, node_t* r, int initializing);
@@ -153,6 +191,9 @@ node_t* new_node_no_init();
 intset_t* set_new();
 void set_delete(intset_t* set);
 int set_size(intset_t* set);
+size_t set_size_approx(intset_t* set);
+size_t set_memory(intset_t* set);
+void set_print_footprint(intset_t* set);
 void node_delete(node_t* node);
 
 #endif	/* _H_BST_TK_ */
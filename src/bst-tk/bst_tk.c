@@ -23,23 +23,102 @@
  */
 
 #include "bst_tk.h"
+#include "node_cache.h"
 
 RETRY_STATS_VARS;
+NODE_CACHE_VARS_DEFINITION();
+
+#if NODE_CACHE_ENTRIES > 0
+/*
+ * The cache keeps internal nodes together with the range [lo, hi) of keys
+ * routed through them. While a node is in the tree its range can only grow
+ * (a delete replaces the parent of a leaf with the sibling subtree), so a
+ * node whose lock did not change since it was cached (i.e., it was not
+ * removed) is a valid start for the search of any key in the cached range.
+ */
+#  define BST_CACHE_VARS()						\
+  skey_t lo, hi, plo = 0, phi = 0;					\
+  skey_t UNUSED pplo = 0, UNUSED pphi = 0
+#  define BST_CACHE_STEP(r, k)			\
+  pplo = plo; pphi = phi;			\
+  plo = lo; phi = hi;				\
+  if (r) { lo = (k); } else { hi = (k); }
+
+static inline int
+bst_tk_is_unlocked(uint64_t v)
+{
+  tl_t tl = { .to_uint64 = v };
+  return (tl.lr[0].version == tl.lr[0].ticket && tl.lr[1].version == tl.lr[1].ticket);
+}
+
+static inline node_t*
+bst_tk_cache_get(intset_t* set, skey_t key, skey_t* lo, skey_t* hi)
+{
+  node_cache_entry_t* e = node_cache_get(key, 0);
+  if (e != NULL)
+    {
+      node_t* node = (node_t*) e->node;
+      if (node->lock.to_uint64 == e->version)
+	{
+	  NODE_CACHE_HIT();
+	  *lo = e->key_lo;
+	  *hi = e->key_hi;
+	  return node;
+	}
+      node_cache_drop(e);
+    }
+
+  *lo = INTPTR_MIN;
+  *hi = INTPTR_MAX;
+  return set->head;
+}
+
+/* locked (or removed) nodes are not cached */
+static inline void
+bst_tk_cache_put(intset_t* set, node_t* node, uint64_t version, skey_t lo, skey_t hi)
+{
+  if (node != NULL && node != set->head && bst_tk_is_unlocked(version))
+    {
+      node_cache_put((void*) node, lo, hi, 0, version);
+    }
+}
+#else
+#  define BST_CACHE_STEP(r, k)
+#endif	/* NODE_CACHE_ENTRIES */
 
 sval_t
 bst_tk_delete(intset_t* set, skey_t key)
 {
   node_t* curr;
+  node_t* next;
   node_t* pred = NULL;
   node_t* ppred = NULL;
   volatile uint64_t curr_ver = 0;
   uint64_t pred_ver = 0, ppred_ver = 0, right = 0, pright = 0;
+#if NODE_CACHE_ENTRIES > 0
+  BST_CACHE_VARS();
+  int from_cache = 1;
+#endif
 
  retry:
   PARSE_TRY();
   UPDATE_TRY();
 
+#if NODE_CACHE_ENTRIES > 0
+  if (likely(from_cache))
+    {
+      curr = bst_tk_cache_get(set, key, &lo, &hi);
+    }
+  else
+    {
+      curr = set->head;
+      lo = INTPTR_MIN;
+      hi = INTPTR_MAX;
+    }
+  pred = NULL;
+#else
   curr = set->head;
+#endif
 
   do
     {
@@ -55,22 +134,37 @@ bst_tk_delete(intset_t* set, skey_t key)
       if (key < curr->key)
 	{
 	  right = 0;
-	  curr = (node_t*) curr->left;
+	  BST_CACHE_STEP(0, curr->key);
+	  next = (node_t*) curr->left;
 	}
       else
 	{
 	  right = 1;
-	  curr = (node_t*) curr->right;
+	  BST_CACHE_STEP(1, curr->key);
+	  next = (node_t*) curr->right;
 	}
+      curr = NODE_PTR(next);
     }
-  while(likely(!curr->leaf));
+  while(likely(!NODE_IS_LEAF_PTR(next)));
 
 
   if (curr->key != key)
     {
+#if NODE_CACHE_ENTRIES > 0
+      bst_tk_cache_put(set, ppred, ppred_ver, pplo, pphi);
+#endif
       return 0;
     }
 
+#if NODE_CACHE_ENTRIES > 0
+  if (unlikely(ppred == NULL))
+    {
+      /* the leaf is a child of the cached node: its parent is unknown */
+      from_cache = 0;
+      goto retry;
+    }
+#endif
+
   if ((!tl_trylock_version(&ppred->lock, (volatile tl_t*) &ppred_ver, pright)))
     {
       goto retry;
@@ -112,6 +206,10 @@ bst_tk_delete(intset_t* set, skey_t key)
   ssmem_free(alloc, pred);
 #endif
 
+#if NODE_CACHE_ENTRIES > 0
+  bst_tk_cache_put(set, ppred, ppred->lock.to_uint64, pplo, pphi);
+#endif
+
   return curr->val;
 } 
 
@@ -120,20 +218,41 @@ bst_tk_find(intset_t* set, skey_t key)
 {
   PARSE_TRY();
 
+#if NODE_CACHE_ENTRIES > 0
+  BST_CACHE_VARS();
+  node_t* curr = bst_tk_cache_get(set, key, &lo, &hi);
+  node_t* pred = NULL, *ppred = NULL;
+  uint64_t pred_ver = 0, ppred_ver = 0;
+#else
   node_t* curr = set->head;
+#endif
+  node_t* next = curr;
 
-  while (likely(!curr->leaf))
+  while (likely(!NODE_IS_LEAF_PTR(next)))
     {
+#if NODE_CACHE_ENTRIES > 0
+      ppred = pred;
+      ppred_ver = pred_ver;
+      pred = curr;
+      pred_ver = curr->lock.to_uint64;
+#endif
       if (key < curr->key)
 	{
-	  curr = (node_t*) curr->left;
+	  BST_CACHE_STEP(0, curr->key);
+	  next = (node_t*) curr->left;
 	}
       else
 	{
-	  curr = (node_t*) curr->right;
+	  BST_CACHE_STEP(1, curr->key);
+	  next = (node_t*) curr->right;
 	}
+      curr = NODE_PTR(next);
     }
 
+#if NODE_CACHE_ENTRIES > 0
+  bst_tk_cache_put(set, ppred, ppred_ver, pplo, pphi);
+#endif
+
   if (curr->key == key)
     {
       return curr->val;
@@ -142,19 +261,56 @@ bst_tk_find(intset_t* set, skey_t key)
   return 0;
 }
 
-int
-bst_tk_insert(intset_t* set, skey_t key, sval_t val) 
+/*
+ * The lock of the side of the parent of a leaf excludes the inserts and
+ * deletes at the leaf. Writing the value does not change any link, so the
+ * lock is reverted, not released: the version stays valid for concurrent
+ * updates and for the node cache. Returns 0 if the parent changed since it
+ * was read with version pred_ver.
+ */
+static inline int
+bst_tk_write_leaf(node_t* pred, uint64_t pred_ver, int right, node_t* leaf, sval_t val,
+		  sval_t expected, sval_t* val_old)
+{
+  if (!tl_trylock_version(&pred->lock, (volatile tl_t*) &pred_ver, right))
+    {
+      return 0;
+    }
+
+  *val_old = leaf->val;
+  if (expected == 0 || *val_old == expected)
+    {
+      leaf->val = val;
+    }
+  tl_revert(&pred->lock, right);
+  return 1;
+}
+
+/*
+ * inserts key, or, if val_old is not NULL and key is in the tree, writes val
+ * to the leaf of key and the previous value to val_old (put)
+ */
+static inline int
+bst_tk_insert_put(intset_t* set, skey_t key, sval_t val, sval_t* val_old) 
 {
   node_t* curr;
+  node_t* next;
   node_t* pred = NULL;
   volatile uint64_t curr_ver = 0;
   uint64_t pred_ver = 0, right = 0;
+#if NODE_CACHE_ENTRIES > 0
+  BST_CACHE_VARS();
+#endif
 
  retry:
   PARSE_TRY();
   UPDATE_TRY();
 
+#if NODE_CACHE_ENTRIES > 0
+  curr = bst_tk_cache_get(set, key, &lo, &hi);
+#else
   curr = set->head;
+#endif
 
   do
     {
@@ -166,24 +322,35 @@ bst_tk_insert(intset_t* set, skey_t key, sval_t val)
       if (key < curr->key)
 	{
 	  right = 0;
-	  curr = (node_t*) curr->left;
+	  BST_CACHE_STEP(0, curr->key);
+	  next = (node_t*) curr->left;
 	}
       else
 	{
 	  right = 1;
-	  curr = (node_t*) curr->right;
+	  BST_CACHE_STEP(1, curr->key);
+	  next = (node_t*) curr->right;
 	}
+      curr = NODE_PTR(next);
     }
-  while(likely(!curr->leaf));
+  while(likely(!NODE_IS_LEAF_PTR(next)));
 
 
   if (curr->key == key)
     {
+      if (val_old != NULL)
+	{
+	  if (!bst_tk_write_leaf(pred, pred_ver, right, curr, val, 0, val_old))
+	    {
+	      goto retry;
+	    }
+	}
       return 0;
     }
 
-  node_t* nn = new_node(key, val, NULL, NULL, 0);
+  /* the internal node first: the new leaf is allocated right after it */
   node_t* nr = new_node_no_init();
+  node_t* nn = new_node(key, val, NULL, NULL, 0);
 
   if ((!tl_trylock_version(&pred->lock, (volatile tl_t*) &pred_ver, right)))
     {
@@ -195,14 +362,14 @@ bst_tk_insert(intset_t* set, skey_t key, sval_t val)
   if (key < curr->key)
     {
       nr->key = curr->key;
-      nr->left = nn;
-      nr->right = curr;
+      nr->left = NODE_LEAF_PTR(nn);
+      nr->right = NODE_LEAF_PTR(curr);
     }
   else
     {
       nr->key = key;
-      nr->left = curr;
-      nr->right = nn;
+      nr->left = NODE_LEAF_PTR(curr);
+      nr->right = NODE_LEAF_PTR(nn);
     }
 
 #if defined(__tile__)
@@ -223,5 +390,144 @@ bst_tk_insert(intset_t* set, skey_t key, sval_t val)
 
   tl_unlock(&pred->lock, right);
 
+#if NODE_CACHE_ENTRIES > 0
+  /* pred is now the grandparent of the new leaf */
+  bst_tk_cache_put(set, pred, pred->lock.to_uint64, plo, phi);
+#endif
   return 1;
 }
+
+int
+bst_tk_insert(intset_t* set, skey_t key, sval_t val) 
+{
+  return bst_tk_insert_put(set, key, val, NULL);
+}
+
+sval_t
+bst_tk_put(intset_t* set, skey_t key, sval_t val) 
+{
+  sval_t val_old = 0;
+  bst_tk_insert_put(set, key, val, &val_old);
+  return val_old;
+}
+
+/*
+ * writes val to the leaf of key if its value is expected (or if expected is
+ * 0), returns the previous value (0 if key is not in the tree)
+ */
+static inline sval_t
+bst_tk_update(intset_t* set, skey_t key, sval_t val, sval_t expected) 
+{
+  node_t* curr;
+  node_t* next;
+  node_t* pred = NULL;
+  uint64_t pred_ver = 0, right = 0;
+  sval_t val_old = 0;
+#if NODE_CACHE_ENTRIES > 0
+  BST_CACHE_VARS();
+#endif
+
+ retry:
+  PARSE_TRY();
+  UPDATE_TRY();
+
+#if NODE_CACHE_ENTRIES > 0
+  curr = bst_tk_cache_get(set, key, &lo, &hi);
+#else
+  curr = set->head;
+#endif
+
+  do
+    {
+      pred = curr;
+      pred_ver = curr->lock.to_uint64;
+
+      if (key < curr->key)
+	{
+	  right = 0;
+	  BST_CACHE_STEP(0, curr->key);
+	  next = (node_t*) curr->left;
+	}
+      else
+	{
+	  right = 1;
+	  BST_CACHE_STEP(1, curr->key);
+	  next = (node_t*) curr->right;
+	}
+      curr = NODE_PTR(next);
+    }
+  while(likely(!NODE_IS_LEAF_PTR(next)));
+
+  if (curr->key != key)
+    {
+      return 0;
+    }
+
+  if (!bst_tk_write_leaf(pred, pred_ver, right, curr, val, expected, &val_old))
+    {
+      goto retry;
+    }
+  return val_old;
+}
+
+sval_t
+bst_tk_replace(intset_t* set, skey_t key, sval_t val) 
+{
+  return bst_tk_update(set, key, val, 0);
+}
+
+int
+bst_tk_cas_value(intset_t* set, skey_t key, sval_t expected, sval_t val) 
+{
+  return (expected != 0 && bst_tk_update(set, key, val, expected) == expected);
+}
+
+static void
+bst_tk_range_rec(volatile node_t* p, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max,
+		 size_t* n)
+{
+  if (*n == max)
+    {
+      return;
+    }
+
+  node_t* curr = NODE_PTR(p);
+  if (NODE_IS_LEAF_PTR(p))
+    {
+      if (curr->key >= lo && curr->key <= hi)
+	{
+	  keys[*n] = curr->key;
+	  vals[*n] = curr->val;
+	  (*n)++;
+	}
+      return;
+    }
+
+  /* keys smaller than the key of an internal node are on its left. The
+     bounds shrink with the path: a subtree that a delete moves up during the
+     scan might later get keys outside the range of the path to it */
+  skey_t key = curr->key;
+  if (lo < key)
+    {
+      bst_tk_range_rec(curr->left, lo, (hi < key) ? hi : key - 1, keys, vals, max, n);
+    }
+  if (hi >= key)
+    {
+      bst_tk_range_rec(curr->right, (lo > key) ? lo : key, hi, keys, vals, max, n);
+    }
+}
+
+/*
+ * copies the keys and values of the (at most max) leaves in [lo, hi], in
+ * order, returns their number. lo and hi must be within (KEY_MIN, KEY_MAX]:
+ * the sentinel leaves are not skipped. Weakly consistent: a scan is not
+ * atomic, but every reported leaf was in the tree at some point during the
+ * scan.
+ */
+size_t
+bst_tk_range(intset_t* set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max)
+{
+  size_t n = 0;
+  bst_tk_range_rec(set->head, lo, hi, keys, vals, max, &n);
+  return n;
+}
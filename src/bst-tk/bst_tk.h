@@ -27,3 +27,10 @@
 sval_t bst_tk_delete(intset_t* set, skey_t key);
 sval_t bst_tk_find(intset_t* set, skey_t key);
 int bst_tk_insert(intset_t* set, skey_t key, sval_t val);
+/* in-place updates: put returns the previous value (0 if it inserted), replace
+   the previous value (0 if key is not in the tree), cas_value 1 on success */
+sval_t bst_tk_put(intset_t* set, skey_t key, sval_t val);
+sval_t bst_tk_replace(intset_t* set, skey_t key, sval_t val);
+int bst_tk_cas_value(intset_t* set, skey_t key, sval_t expected, sval_t val);
+/* the (at most max) keys in [lo, hi], in order (weakly consistent) */
+size_t bst_tk_range(intset_t* set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max);
@@ -32,11 +32,41 @@ set_contains(intset_t* set, skey_t key)
 int
 set_add(intset_t* set, skey_t key, sval_t val)
 {  
-  return bst_tk_insert(set, key, val);
+  int ret = bst_tk_insert(set, key, val);
+  SIZE_COUNTER_INC(set->sizes, ret);
+  return ret;
 }
 
 sval_t
 set_remove(intset_t* set, skey_t key)
 {
-  return bst_tk_delete(set, key);
+  sval_t ret = bst_tk_delete(set, key);
+  SIZE_COUNTER_DEC(set->sizes, ret != 0);
+  return ret;
+}
+
+sval_t
+set_put(intset_t* set, skey_t key, sval_t val)
+{
+  sval_t ret = bst_tk_put(set, key, val);
+  SIZE_COUNTER_INC(set->sizes, ret == 0);
+  return ret;
+}
+
+sval_t
+set_replace(intset_t* set, skey_t key, sval_t val)
+{
+  return bst_tk_replace(set, key, val);
+}
+
+int
+set_cas_value(intset_t* set, skey_t key, sval_t expected, sval_t val)
+{
+  return bst_tk_cas_value(set, key, expected, val);
+}
+
+size_t
+set_range(intset_t* set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max)
+{
+  return bst_tk_range(set, lo, hi, keys, vals, max);
 }
@@ -25,3 +25,7 @@
 sval_t set_contains(intset_t *set, skey_t key);
 int set_add(intset_t *set, skey_t key, sval_t val);
 sval_t set_remove(intset_t *set, skey_t key);
+sval_t set_put(intset_t *set, skey_t key, sval_t val);
+sval_t set_replace(intset_t *set, skey_t key, sval_t val);
+int set_cas_value(intset_t *set, skey_t key, sval_t expected, sval_t val);
+size_t set_range(intset_t *set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max);
@@ -48,19 +48,30 @@
 #endif
 
 #include "intset.h"
+#include "shard.h"
+#include "in_place.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
  * ################################################################### */
 
-#define DS_CONTAINS(s,k,t)    set_contains(s, k)
-#define DS_ADD(s,k,t)         set_add(s, k, k)
-#define DS_REMOVE(s,k,t)      set_remove(s, k)
-#define DS_SIZE(s)            set_size(s)
-#define DS_NEW()              set_new()
+#define DS_CONTAINS_LOCAL(s,k,t) set_contains(s, k)
+/* with -U, inserts rotate over put, replace, and cas_value (see in_place.h) */
+#define DS_ADD_LOCAL(s,k,t)      (in_place ? IN_PLACE_ADD(s, k, set_put, set_replace, set_cas_value, set_contains) \
+                                  : set_add(s, k, k))
+#define DS_REMOVE_LOCAL(s,k,t)   set_remove(s, k)
+
+/* with -P, on the shard of the key (see shard.h); with -g, searches are range scans */
+#define DS_CONTAINS(s,k,t)       (scan_len ? ds_scan(s, k) : SHARD_OP(s, k, t, DS_CONTAINS_LOCAL))
+#define DS_ADD(s,k,t)            SHARD_OP(s, k, t, DS_ADD_LOCAL)
+#define DS_REMOVE(s,k,t)         SHARD_OP(s, k, t, DS_REMOVE_LOCAL)
+#define DS_SIZE(s)               SHARD_SUM(s, set_size)
+#define DS_SIZE_APPROX(s)        SHARD_SUM(s, set_size_approx)
+#define DS_NEW()                 set_new()
 
 #define DS_TYPE               intset_t
 #define DS_NODE               node_t
+#define DS_MEMORY(s)          SHARD_SUM(s, set_memory)
 
 /* ################################################################### *
  * GLOBALS
@@ -74,6 +85,12 @@ size_t load_factor;
 size_t update = DEFAULT_UPDATE;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+int in_place = 0;
+IN_PLACE_VARS_DEFINITION();
+size_t num_shards = 0;
+int shard_policy = SHARD_HASH;
+int shard_affinity = 0;
+size_t scan_len = 0;
 int test_verbose = 0;
 
 size_t print_vals_num = 100; 
@@ -82,6 +99,7 @@ size_t put, put_explicit = false;
 double update_rate, put_rate, get_rate;
 
 size_t size_after = 0;
+size_t memory_after = 0;
 int seed = 0;
 __thread unsigned long * seeds;
 uint32_t rand_max;
@@ -89,6 +107,7 @@ uint32_t rand_max;
 
 static volatile int stop;
 TEST_VARS_GLOBAL;
+SHARD_VARS_DEFINITION();
 
 volatile ticks *putting_succ;
 volatile ticks *putting_fail;
@@ -117,6 +136,18 @@ extern __thread uint32_t put_num_failed_on_new;
 
 barrier_t barrier, barrier_global;
 
+/* with -g, a search scans the (at most scan_len) keys in [key, key + scan_len) */
+static __thread skey_t* scan_keys;
+static __thread sval_t* scan_vals;
+
+static size_t
+ds_scan(DS_TYPE* set, skey_t key)
+{
+  key = shard_key(&__shards, key);
+  return shard_scan(&__shards, set, (shard_scan_t) set_range,
+		    key, key + scan_len - 1, scan_keys, scan_vals, scan_len);
+}
+
 typedef struct thread_data
 {
   uint32_t id;
@@ -158,10 +189,17 @@ test(void* thread)
 #endif
     
   seeds = seed_rand();
+  if (scan_len > 0)
+    {
+      scan_keys = (skey_t*) malloc(scan_len * sizeof(skey_t));
+      scan_vals = (sval_t*) malloc(scan_len * sizeof(sval_t));
+      assert(scan_keys != NULL && scan_vals != NULL);
+    }
 #if GC == 1
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
 
   RR_INIT(phys_id);
@@ -185,6 +223,26 @@ test(void* thread)
   key = range;
 #endif
 
+  if (__shards.num)
+    {
+      /* the threads of a node fill the shards of the node */
+      uint32_t sh;
+      for (sh = 0; sh < __shards.num; sh++)
+	{
+	  size_t n = shard_fill_count(&__shards, sh, ID, num_threads);
+	  for(i = 0; i < n; i++)
+	    {
+	      key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
+	      key = shard_key_of(&__shards, sh, key);
+	      if(shard_of(&__shards, key) != sh || DS_ADD(set, key, NULL) == false)
+		{
+		  i--;
+		}
+	    }
+	}
+      num_elems_thread = 0;
+    }
+
   for(i = 0; i < num_elems_thread; i++) 
     {
       key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
@@ -193,6 +251,7 @@ test(void* thread)
 	  i--;
 	}
     }
+  in_place_start();
   MEM_BARRIER;
 
   barrier_cross(&barrier);
@@ -201,11 +260,16 @@ test(void* thread)
     {
       printf("#BEFORE size is: %zu\n", (size_t) DS_SIZE(set));
     }
+  /* the initial keys are spread over all the shards */
+  shard_thread_home(&__shards, ID);
 
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -213,6 +277,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -220,7 +285,17 @@ test(void* thread)
   if (!ID)
     {
       size_after = DS_SIZE(set);
+      memory_after = DS_MEMORY(set);
       printf("#AFTER  size is: %zu\n", size_after);
+#if SIZE_COUNTERS == 1
+      size_t size_approx = DS_SIZE_APPROX(set);
+      printf("#AFTER  size (counters): %zu\n", size_approx);
+      if (size_approx != size_after)
+	{
+	  printf("// WRONG size counters. %zu != %zu\n", size_approx, size_after);
+	}
+#endif
+      set_print_footprint(set);
     }
 
   barrier_cross(&barrier);
@@ -240,6 +315,7 @@ test(void* thread)
   putting_count_succ[ID] += my_putting_count_succ;
   getting_count_succ[ID] += my_getting_count_succ;
   removing_count_succ[ID]+= my_removing_count_succ;
+  in_place_publish();
 
   EXEC_IN_DEC_ID_ORDER(ID, num_threads)
     {
@@ -249,7 +325,11 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
+  free(scan_keys);
+  free(scan_vals);
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -276,6 +356,12 @@ main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {"in-place",                  no_argument,       NULL, 'U'},
+    {"shards",                    required_argument, NULL, 'P'},
+    {"shard-range",               no_argument,       NULL, 'R'},
+    {"shard-affinity",            no_argument,       NULL, 'L'},
+    {"range-scan",                required_argument, NULL, 'g'},
     {NULL, 0, NULL, 0}
   };
 
@@ -283,7 +369,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:el:p:b:v:f:x:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:el:p:b:v:f:x:S:UP:RLg:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -331,6 +417,18 @@ main(int argc, char **argv)
 		 "        1 = lock-coupling,\n"
 		 "        2 = lazy algorithm\n"
 		 "        3 = Pugh's lazy algorithm\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 "  -U, --in-place\n"
+		 "        Inserts rotate over put, replace, and cas_value (in-place updates of present keys)\n"
+		 "  -P, --shards <int>\n"
+		 "        Partition the keys (by hash) over <int> instances spread over the NUMA nodes\n"
+		 "  -R, --shard-range\n"
+		 "        Partition the keys by range (with -P)\n"
+		 "  -L, --shard-affinity\n"
+		 "        Every thread uses only the keys of a shard on its node (with -P)\n"
+		 "  -g, --range-scan <int>\n"
+		 "        Searches are range scans of (at most) <int> keys\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -364,6 +462,24 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case 'U':
+	  in_place = 1;
+	  break;
+	case 'P':
+	  num_shards = atoi(optarg);
+	  break;
+	case 'R':
+	  shard_policy = SHARD_RANGE;
+	  break;
+	case 'L':
+	  shard_affinity = 1;
+	  break;
+	case 'g':
+	  scan_len = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -433,7 +549,18 @@ main(int argc, char **argv)
     
   stop = 0;
     
-  DS_TYPE* set = DS_NEW();
+  DS_TYPE* set;
+  if (num_shards > 0)
+    {
+      shard_init(&__shards, num_shards, shard_policy, shard_affinity, rand_min, rand_max + 1,
+		 initial, (shard_new_t) set_new);
+      shard_print(&__shards);
+      set = (DS_TYPE*) __shards.set[0];
+    }
+  else
+    {
+      set = DS_NEW();
+    }
   assert(set != NULL);
 
   /* Initializes the local data */
@@ -571,10 +698,20 @@ main(int argc, char **argv)
 	 (LLU) putting_count_total_succ, putting_perc_succ, putting_perc, (putting_perc * putting_perc_succ) / 100);
   printf("rems: %-10llu | %-10llu | %10.1f%% | %10.1f%% | %10.1f%%\n", (LLU) removing_count_total, 
 	 (LLU) removing_count_total_succ, removing_perc_succ, removing_perc, (removing_perc * removing_perc_succ) / 100);
+  if (scan_len > 0)
+    {
+      printf("#range scans of (at most) %zu keys\n", scan_len);
+    }
+  if (in_place)
+    {
+      in_place_print();
+    }
 
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(memory_after, size_after, sizeof(DS_NODE));
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();
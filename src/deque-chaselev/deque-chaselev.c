@@ -0,0 +1,111 @@
+/*
+ *   File: deque-chaselev.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: Chase-Lev work-stealing deque
+ *   deque-chaselev.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * The work-stealing deque of Chase and Lev, with the memory orderings of Le
+ * et al. for weak memory models. The owner pushes and pops at the bottom
+ * with plain loads and stores; thieves steal at the top with a CAS. The owner
+ * only synchronizes with the thieves (fence and CAS) when it pops the last
+ * element. On x86, steal needs no fence: loads are not reordered with other
+ * loads and the CAS is a full barrier.
+ *
+ * The values 0 and -1 are reserved (DEQUE_EMPTY and DEQUE_ABORT).
+ */
+
+#include "deque-chaselev.h"
+#include "utils.h"
+
+RETRY_STATS_VARS;
+
+#include "latency.h"
+#if LATENCY_PARSING == 1
+__thread size_t lat_parsing_get = 0;
+__thread size_t lat_parsing_put = 0;
+__thread size_t lat_parsing_rem = 0;
+#endif	/* LATENCY_PARSING == 1 */
+
+int
+deque_chaselev_push(deque_t* dq, sval_t val)
+{
+  int64_t b = dq->bottom;
+  int64_t t = dq->top;
+  deque_array_t* a = dq->array;
+  if (unlikely(b - t >= (int64_t) a->size))
+    {
+      a = deque_grow(dq, a, t, b);
+    }
+  a->slots[b & a->mask] = val;
+#ifdef __tile__
+  MEM_BARRIER;
+#endif
+  dq->bottom = b + 1;
+  return 1;
+}
+
+sval_t
+deque_chaselev_pop(deque_t* dq)
+{
+  int64_t b = dq->bottom - 1;
+  deque_array_t* a = dq->array;
+  dq->bottom = b;
+  DEQUE_FENCE();
+  int64_t t = dq->top;
+
+  if (likely(t < b))
+    {
+      /* more than one element: no thief can reach slot b */
+      return a->slots[b & a->mask];
+    }
+
+  sval_t val = DEQUE_EMPTY;
+  if (t == b)
+    {
+      /* the last element: race the thieves for it */
+      val = a->slots[b & a->mask];
+      if (CAS_U64((volatile uint64_t*) &dq->top, (uint64_t) t, (uint64_t) (t + 1)) != (uint64_t) t)
+	{
+	  val = DEQUE_EMPTY;
+	}
+    }
+  dq->bottom = b + 1;
+  return val;
+}
+
+sval_t
+deque_chaselev_steal(deque_t* dq)
+{
+  int64_t t = dq->top;
+  COMPILER_BARRIER();
+  int64_t b = dq->bottom;
+  if (t >= b)
+    {
+      return DEQUE_EMPTY;
+    }
+
+  deque_array_t* a = dq->array;
+  sval_t val = a->slots[t & a->mask];
+  if (CAS_U64((volatile uint64_t*) &dq->top, (uint64_t) t, (uint64_t) (t + 1)) != (uint64_t) t)
+    {
+      return DEQUE_ABORT;
+    }
+  return val;
+}
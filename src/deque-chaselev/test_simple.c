@@ -0,0 +1,503 @@
+/*
+ *   File: test_simple.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: fork-join test of the work-stealing deques
+ *   test_simple.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include <assert.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <sched.h>
+#include <inttypes.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <malloc.h>
+#include "utils.h"
+#include "atomic_ops.h"
+#include "rapl_read.h"
+#ifdef __sparc__
+#  include <sys/types.h>
+#  include <sys/processor.h>
+#  include <sys/procset.h>
+#endif
+
+#include "intset.h"
+
+/* 
+ * Fork-join test. Every thread owns a deque. A task is a node of a tree of
+ * depth -t where every node has -k children; running a task spins for -w
+ * cycles and pushes its children to the deque of the thread. Threads pop
+ * from their own deque and, when it is empty, steal from the deque of a
+ * random victim. Thread 0 spawns a new tree whenever its deque is empty. The
+ * test reports the throughput (tasks / s) and the steal rate.
+ *
+ * The value of a task is its remaining depth + 1 (0 and -1 are reserved).
+ */
+
+/* ################################################################### *
+ * Definition of macros: per data structure
+ * ################################################################### */
+
+#define DS_PUSH(s,v)        deque_push(s, v)
+#define DS_POP(s)           deque_pop(s)
+#define DS_STEAL(s)         deque_steal(s)
+#define DS_SIZE(s)          deque_size(s)
+#define DS_NEW(n)           deque_new(n)
+
+#define DS_TYPE             deque_t
+#define DS_NODE             sval_t
+
+/* ################################################################### *
+ * GLOBALS
+ * ################################################################### */
+
+RETRY_STATS_VARS_GLOBAL;
+
+size_t initial = DEQUE_INITIAL_SIZE;
+size_t num_threads = DEFAULT_NB_THREADS; 
+size_t duration = DEFAULT_DURATION;
+size_t tree_depth = 14;
+size_t fan_out = 2;
+size_t task_work = 256;
+
+size_t print_vals_num = 100; 
+size_t pf_vals_num = 1023;
+
+size_t size_after = 0;
+size_t tasks_left = 0;		/* tasks of the trees left in the deques */
+size_t* tree_size;		/* tasks of a tree of depth d */
+int seed = 0;
+__thread unsigned long * seeds;
+
+static volatile int stop;
+TEST_VARS_GLOBAL;
+
+DS_TYPE** deques;
+
+typedef struct fj_stats
+{
+  uint64_t tasks;
+  uint64_t roots;
+  uint64_t steals;
+  uint64_t steal_tries;
+  uint64_t steal_aborts;
+  uint8_t padding[CACHE_LINE_SIZE - 5 * sizeof(uint64_t)];
+} fj_stats_t;
+
+fj_stats_t* fj_stats;
+
+/* ################################################################### *
+ * LOCALS
+ * ################################################################### */
+
+barrier_t barrier, barrier_global;
+
+typedef struct thread_data
+{
+  uint32_t id;
+  DS_TYPE* set;
+} thread_data_t;
+
+void*
+test(void* thread) 
+{
+  thread_data_t* td = (thread_data_t*) thread;
+  uint32_t ID = td->id;
+  set_cpu(ID);
+  ssalloc_init();
+
+  DS_TYPE* set = td->set;
+
+  THREAD_INIT(ID);
+  PF_INIT(3, SSPFD_NUM_ENTRIES, ID);
+
+  fj_stats_t my = { 0 };
+    
+  seeds = seed_rand();
+#if GC == 1
+  alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
+  assert(alloc != NULL);
+  ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
+#endif
+
+  RR_INIT(phys_id);
+  barrier_cross(&barrier);
+
+  if (!ID)
+    {
+      printf("#BEFORE size is: %zu\n", (size_t) DS_SIZE(set));
+    }
+
+  RETRY_STATS_ZERO();
+
+  PE_INIT();
+  barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
+
+  RR_START_SIMPLE();
+
+  while (stop == 0) 
+    {
+      sval_t task = DS_POP(set);
+      if (task == DEQUE_EMPTY)
+	{
+	  if (ID == 0)
+	    {
+	      task = tree_depth + 1;
+	      my.roots++;
+	    }
+	  else
+	    {
+	      uint32_t victim = (ID + 1 + my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (num_threads - 1)) % num_threads;
+	      task = DS_STEAL(deques[victim]);
+	      my.steal_tries++;
+	      if (task == DEQUE_EMPTY || task == DEQUE_ABORT)
+		{
+		  my.steal_aborts += (task == DEQUE_ABORT);
+#if GC == 1
+		  SSMEM_SAFE_TO_RECLAIM();
+#endif
+		  PAUSE;
+		  continue;
+		}
+	      my.steals++;
+	    }
+	}
+
+      /* run the task: work, then fork its children */
+      if (task_work > 0)
+	{
+	  cpause(task_work);
+	}
+      my.tasks++;
+      if (task > 1)
+	{
+	  size_t c;
+	  for (c = 0; c < fan_out; c++)
+	    {
+	      DS_PUSH(set, task - 1);
+	    }
+	}
+#if GC == 1
+      SSMEM_SAFE_TO_RECLAIM();
+#endif
+    }
+  PE_STOP();
+
+  barrier_cross(&barrier);
+  RR_STOP_SIMPLE();
+
+  if (!ID)
+    {
+      /* the threads are done: drain the deques and count the tasks left */
+      size_t t;
+      for (t = 0; t < num_threads; t++)
+	{
+	  size_after += DS_SIZE(deques[t]);
+	  sval_t left;
+	  while ((left = DS_POP(deques[t])) != DEQUE_EMPTY)
+	    {
+	      tasks_left += tree_size[left - 1];
+	    }
+	}
+      printf("#AFTER  size is: %zu\n", size_after);
+    }
+
+  barrier_cross(&barrier);
+
+  fj_stats[ID] = my;
+
+  EXEC_IN_DEC_ID_ORDER(ID, num_threads)
+    {
+      print_latency_stats(ID, SSPFD_NUM_ENTRIES, print_vals_num);
+      RETRY_STATS_SHARE();
+    }
+  EXEC_IN_DEC_ID_ORDER_END(&barrier);
+
+  SSPFDTERM();
+  PE_TERM();
+#if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
+  ssmem_term();
+  free(alloc);
+#endif
+  THREAD_END();
+  pthread_exit(NULL);
+}
+
+int
+main(int argc, char **argv) 
+{
+  set_cpu(0);
+  ssalloc_init();
+  seeds = seed_rand();
+
+  struct option long_options[] = {
+    // These options don't set a flag
+    {"help",                      no_argument,       NULL, 'h'},
+    {"duration",                  required_argument, NULL, 'd'},
+    {"initial-size",              required_argument, NULL, 'i'},
+    {"num-threads",               required_argument, NULL, 'n'},
+    {"tree-depth",                required_argument, NULL, 't'},
+    {"fan-out",                   required_argument, NULL, 'k'},
+    {"work",                      required_argument, NULL, 'w'},
+    {"print-vals",                required_argument, NULL, 'v'},
+    {"vals-pf",                   required_argument, NULL, 'f'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {NULL, 0, NULL, 0}
+  };
+
+  int i, c;
+  while(1) 
+    {
+      i = 0;
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:u:p:b:l:t:k:w:v:f:S:", long_options, &i);
+		
+      if(c == -1)
+	break;
+		
+      if(c == 0 && long_options[i].flag == 0)
+	c = long_options[i].val;
+		
+      switch(c) 
+	{
+	case 0:
+	  /* Flag is automatically set */
+	  break;
+	case 'h':
+	  printf("ASCYLIB -- fork-join test "
+		 "\n"
+		 "\n"
+		 "Usage:\n"
+		 "  %s [options...]\n"
+		 "\n"
+		 "Options:\n"
+		 "  -h, --help\n"
+		 "        Print this message\n"
+		 "  -d, --duration <int>\n"
+		 "        Test duration in milliseconds\n"
+		 "  -i, --initial-size <int>\n"
+		 "        Initial number of slots of the deques (grown on demand)\n"
+		 "  -n, --num-threads <int>\n"
+		 "        Number of threads\n"
+		 "  -t, --tree-depth <int>\n"
+		 "        Depth of the task trees that thread 0 spawns\n"
+		 "  -k, --fan-out <int>\n"
+		 "        Children of every task of the trees\n"
+		 "  -w, --work <int>\n"
+		 "        Cycles of work per task\n"
+		 "  -v, --print-vals <int>\n"
+		 "        When using detailed profiling, how many values to print.\n"
+		 "  -f, --val-pf <int>\n"
+		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 , argv[0]);
+	  exit(0);
+	case 'd':
+	  duration = atoi(optarg);
+	  break;
+	case 'i':
+	  initial = atoi(optarg);
+	  break;
+	case 'n':
+	  num_threads = atoi(optarg);
+	  break;
+	case 'r':
+	case 'u':
+	case 'p':
+	case 'b':
+	case 'l':
+	  /* options of the set tests (e.g., from the scripts): no effect */
+	  break;
+	case 't':
+	  tree_depth = atoi(optarg);
+	  break;
+	case 'k':
+	  fan_out = atoi(optarg);
+	  break;
+	case 'w':
+	  task_work = atoi(optarg);
+	  break;
+	case 'v':
+	  print_vals_num = atoi(optarg);
+	  break;
+	case 'f':
+	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
+	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case '?':
+	default:
+	  printf("Use -h or --help for help\n");
+	  exit(1);
+	}
+    }
+
+  if (!is_power_of_two(initial))
+    {
+      size_t initial_pow2 = pow2roundup(initial);
+      printf("** rounding up initial (to make it power of 2): old: %zu / new: %zu\n", initial, initial_pow2);
+      initial = initial_pow2;
+    }
+
+  if (fan_out < 1)
+    {
+      fan_out = 1;
+    }
+
+  tree_size = (size_t*) malloc((tree_depth + 1) * sizeof(size_t));
+  size_t d;
+  for (d = 0; d <= tree_depth; d++)
+    {
+      tree_size[d] = 1 + ((d > 0) ? fan_out * tree_size[d - 1] : 0);
+    }
+
+  printf("## Initial: %zu slots / Tree depth: %zu / Fan-out: %zu (%zu tasks per tree) / Work: %zu cycles / ",
+	 initial, tree_depth, fan_out, tree_size[tree_depth], task_work);
+  printf("Chase-Lev deque\n");
+
+  struct timeval start, end;
+  struct timespec timeout;
+  timeout.tv_sec = duration / 1000;
+  timeout.tv_nsec = (duration % 1000) * 1000000;
+    
+  stop = 0;
+
+  deques = (DS_TYPE**) malloc(num_threads * sizeof(DS_TYPE*));
+  fj_stats = (fj_stats_t*) calloc(num_threads, sizeof(fj_stats_t));
+    
+  pthread_t threads[num_threads];
+  pthread_attr_t attr;
+  int rc;
+  void *status;
+    
+  barrier_init(&barrier_global, num_threads + 1);
+  barrier_init(&barrier, num_threads);
+    
+  /* Initialize and set thread detached attribute */
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_JOINABLE);
+    
+  thread_data_t* tds = (thread_data_t*) malloc(num_threads * sizeof(thread_data_t));
+
+  long t;
+  for(t = 0; t < num_threads; t++)
+    {
+      deques[t] = DS_NEW(initial);
+      assert(deques[t] != NULL);
+    }
+
+  for(t = 0; t < num_threads; t++)
+    {
+      tds[t].id = t;
+      tds[t].set = deques[t];
+      rc = pthread_create(&threads[t], &attr, test, tds + t);
+      if (rc)
+	{
+	  printf("ERROR; return code from pthread_create() is %d\n", rc);
+	  exit(-1);
+	}
+        
+    }
+    
+  /* Free attribute and wait for the other threads */
+  pthread_attr_destroy(&attr);
+    
+  barrier_cross(&barrier_global);
+  gettimeofday(&start, NULL);
+  nanosleep(&timeout, NULL);
+
+  stop = 1;
+  gettimeofday(&end, NULL);
+  duration = (end.tv_sec * 1000 + end.tv_usec / 1000) - (start.tv_sec * 1000 + start.tv_usec / 1000);
+    
+  for(t = 0; t < num_threads; t++) 
+    {
+      rc = pthread_join(threads[t], &status);
+      if (rc) 
+	{
+	  printf("ERROR; return code from pthread_join() is %d\n", rc);
+	  exit(-1);
+	}
+    }
+
+  free(tds);
+
+#define LLU long long unsigned int
+
+  fj_stats_t tot = { 0 };
+  for(t = 0; t < num_threads; t++) 
+    {
+      fj_stats_t* s = &fj_stats[t];
+#if OPS_PER_THREAD == 1
+      printf("%-3ld tasks: %-10llu steals: %-10llu / %-10llu tries (%llu aborted)\n", t,
+	     (LLU) s->tasks, (LLU) s->steals, (LLU) s->steal_tries, (LLU) s->steal_aborts);
+#endif
+      tot.tasks += s->tasks;
+      tot.roots += s->roots;
+      tot.steals += s->steals;
+      tot.steal_tries += s->steal_tries;
+      tot.steal_aborts += s->steal_aborts;
+    }
+
+  /* every task of the spawned trees either ran or is (in a subtree) left in a deque */
+  size_t tasks_spawned = tot.roots * tree_size[tree_depth];
+  if (tot.tasks + tasks_left != tasks_spawned)
+    {
+      printf("// WRONG task count. %llu + %zu != %zu\n", (LLU) tot.tasks, tasks_left, tasks_spawned);
+      assert(tot.tasks + tasks_left == tasks_spawned);
+    }
+
+  printf("#trees: %-10llu | tasks: %-12llu | left: %zu\n", (LLU) tot.roots, (LLU) tot.tasks, tasks_left);
+  printf("#steals: %-10llu | tries: %-12llu | succ %5.1f%% | aborted %5.1f%% | tasks per steal %.1f\n",
+	 (LLU) tot.steals, (LLU) tot.steal_tries,
+	 tot.steal_tries ? 100.0 * tot.steals / tot.steal_tries : 0.0,
+	 tot.steal_tries ? 100.0 * tot.steal_aborts / tot.steal_tries : 0.0,
+	 tot.steals ? (double) tot.tasks / tot.steals : 0.0);
+  printf("#steal rate %.0f / s\n", tot.steals * 1000.0 / duration);
+
+  double throughput = tot.tasks * 1000.0 / duration;
+  printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
+  printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(tot.tasks);
+  MEM_STATS_PRINT(0, size_after, sizeof(DS_NODE));
+
+  RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
+  RR_PRINT_CORRECTED();
+  RETRY_STATS_PRINT(tot.tasks + tot.steal_tries, 0, tot.steal_tries, tot.steals);
+  LATENCY_DISTRIBUTION_PRINT();
+    
+  pthread_exit(NULL);
+    
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ *   File: deque-array.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: circular arrays and layout of the work-stealing deque
+ *   deque-array.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "deque-array.h"
+#include "utils.h"
+
+__thread ssmem_allocator_t* alloc;
+
+deque_array_t*
+deque_new_array(size_t size)
+{
+  /* arrays of all sizes are released to the os, thus not from ssmem */
+  deque_array_t* a = memalign(CACHE_LINE_SIZE, sizeof(deque_array_t) + size * sizeof(sval_t));
+  if (a == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+  a->size = size;
+  a->mask = size - 1;
+  return a;
+}
+
+deque_array_t*
+deque_grow(deque_t* dq, deque_array_t* a, int64_t top, int64_t bottom)
+{
+  deque_array_t* a_new = deque_new_array(a->size << 1);
+  int64_t i;
+  for (i = top; i < bottom; i++)
+    {
+      a_new->slots[i & a_new->mask] = a->slots[i & a->mask];
+    }
+
+#ifdef __tile__
+  MEM_BARRIER;
+#endif
+  dq->array = a_new;
+
+#if GC == 1
+  ssmem_release(alloc, (void*) a);
+#endif
+  return a_new;
+}
+
+deque_t*
+deque_new(size_t size)
+{
+  deque_t *set;
+
+  if ((set = (deque_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(deque_t))) == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+
+  set->top = 0;
+  optik_init(&set->lock);
+  set->bottom = 0;
+  set->array = deque_new_array(size);
+
+  return set;
+}
+
+void
+deque_delete(deque_t *set)
+{
+  free(set->array);
+}
+
+int
+deque_size(deque_t *set)
+{
+  int64_t size = set->bottom - set->top;
+  return (size > 0) ? (int) size : 0;
+}
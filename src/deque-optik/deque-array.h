@@ -0,0 +1,92 @@
+/*
+ *   File: deque-array.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: circular arrays and layout of the work-stealing deque
+ *   deque-array.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include <assert.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
+#include <malloc.h>
+
+#include "common.h"
+
+#include <atomic_ops.h>
+#include "lock_if.h"
+#include "ssmem.h"
+#include "optik.h"
+
+extern unsigned int global_seed;
+extern __thread ssmem_allocator_t* alloc;
+
+/* default number of slots of a new deque (a power of 2) */
+#ifndef DEQUE_INITIAL_SIZE
+#  define DEQUE_INITIAL_SIZE 16
+#endif
+
+/* return values of pop and steal: no element / lost a race with another thief */
+#define DEQUE_EMPTY ((sval_t) 0)
+#define DEQUE_ABORT ((sval_t) -1)
+
+/* 
+ * The pop of the owner must order its store to bottom before its load of top
+ * (MEM_BARRIER is a no-op on x86)
+ */
+#define DEQUE_FENCE() __sync_synchronize()
+
+/* 
+ * The elements are in slots[top .. bottom - 1] (modulo size) of a circular
+ * array. When the owner finds the array full, it copies the elements to an
+ * array of twice the size and publishes it. Thieves might still read the old
+ * array, so it is given back with ssmem_release (free-d once every thread has
+ * passed a quiescent point). Arrays never shrink. top is only written while
+ * holding lock.
+ */
+typedef struct deque_array
+{
+  size_t size;
+  size_t mask;
+  volatile sval_t slots[];
+} deque_array_t;
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct deque
+{
+  volatile int64_t top;		/* thieves */
+  optik_t lock;
+  uint8_t padding1[CACHE_LINE_SIZE - sizeof(int64_t) - sizeof(optik_t)];
+  volatile int64_t bottom;	/* owner */
+  deque_array_t* volatile array;
+  uint8_t padding2[CACHE_LINE_SIZE - sizeof(int64_t) - sizeof(deque_array_t*)];
+} deque_t;
+
+deque_array_t* deque_new_array(size_t size);
+/* 
+ * Grow the array of dq (owner only) and copy the elements top .. bottom - 1.
+ */
+deque_array_t* deque_grow(deque_t* dq, deque_array_t* a, int64_t top, int64_t bottom);
+deque_t* deque_new(size_t size);
+void deque_delete(deque_t* dq);
+int deque_size(deque_t* dq);
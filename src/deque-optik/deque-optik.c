@@ -0,0 +1,123 @@
+/*
+ *   File: deque-optik.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: Chase-Lev work-stealing deque with OPTIK steals
+ *   deque-optik.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+/*
+ * The Chase-Lev deque (see deque-chaselev), where the CAS on top is replaced
+ * by an OPTIK lock. A thief reads the version of the lock before top and
+ * bottom, and then takes the element with optik_trylock_version. Thus, a
+ * thief that is late (another thief or the owner took the lock meanwhile)
+ * fails with a read and without writing to the lock, and a thief that sees
+ * the lock taken moves to another victim. The owner takes the lock only
+ * when it pops the last element. Push and the rest of pop are as in
+ * deque-chaselev.
+ *
+ * The values 0 and -1 are reserved (DEQUE_EMPTY and DEQUE_ABORT).
+ */
+
+#include "deque-optik.h"
+#include "utils.h"
+
+RETRY_STATS_VARS;
+
+#include "latency.h"
+#if LATENCY_PARSING == 1
+__thread size_t lat_parsing_get = 0;
+__thread size_t lat_parsing_put = 0;
+__thread size_t lat_parsing_rem = 0;
+#endif	/* LATENCY_PARSING == 1 */
+
+int
+deque_optik_push(deque_t* dq, sval_t val)
+{
+  int64_t b = dq->bottom;
+  int64_t t = dq->top;
+  deque_array_t* a = dq->array;
+  if (unlikely(b - t >= (int64_t) a->size))
+    {
+      a = deque_grow(dq, a, t, b);
+    }
+  a->slots[b & a->mask] = val;
+#ifdef __tile__
+  MEM_BARRIER;
+#endif
+  dq->bottom = b + 1;
+  return 1;
+}
+
+sval_t
+deque_optik_pop(deque_t* dq)
+{
+  int64_t b = dq->bottom - 1;
+  deque_array_t* a = dq->array;
+  dq->bottom = b;
+  DEQUE_FENCE();
+  int64_t t = dq->top;
+
+  if (likely(t < b))
+    {
+      /* more than one element: no thief can reach slot b */
+      return a->slots[b & a->mask];
+    }
+
+  sval_t val = DEQUE_EMPTY;
+  if (t == b)
+    {
+      /* the last element: race the thieves for it */
+      optik_lock(&dq->lock);
+      if (dq->top == t)
+	{
+	  val = a->slots[b & a->mask];
+	  dq->top = t + 1;
+	}
+      optik_unlock(&dq->lock);
+    }
+  dq->bottom = b + 1;
+  return val;
+}
+
+sval_t
+deque_optik_steal(deque_t* dq)
+{
+  optik_t version = dq->lock;
+  if (unlikely(optik_is_locked(version)))
+    {
+      return DEQUE_ABORT;
+    }
+  COMPILER_BARRIER();
+  int64_t t = dq->top;
+  COMPILER_BARRIER();
+  int64_t b = dq->bottom;
+  if (t >= b)
+    {
+      return DEQUE_EMPTY;
+    }
+
+  deque_array_t* a = dq->array;
+  sval_t val = a->slots[t & a->mask];
+  /* top has not changed since version, iff no one took the lock meanwhile */
+  if (!optik_trylock_version(&dq->lock, version))
+    {
+      return DEQUE_ABORT;
+    }
+  dq->top = t + 1;
+  optik_unlock(&dq->lock);
+  return val;
+}
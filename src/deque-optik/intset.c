@@ -0,0 +1,41 @@
+/*
+ *   File: intset.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: Work-stealing deque interface
+ *   intset.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "intset.h"
+
+inline int
+deque_push(deque_t *set, sval_t val)
+{
+  return deque_optik_push(set, val);
+}
+
+inline sval_t
+deque_pop(deque_t *set)
+{
+  return deque_optik_pop(set);
+}
+
+inline sval_t
+deque_steal(deque_t *set)
+{
+  return deque_optik_steal(set);
+}
@@ -76,12 +76,15 @@ copy_on_write_new_init(size_t num_buckets)
 
   cow->array = ssalloc_aligned(CACHE_LINE_SIZE, cow->num_buckets * sizeof(array_ll_t*));
   assert(cow->array != NULL);
+  cow->pending = ssalloc_aligned(CACHE_LINE_SIZE, cow->num_buckets * sizeof(cpy_req_t*));
+  assert(cow->pending != NULL);
 
   int i;
   for (i = 0; i < cow->num_buckets; i++)
     {
       INIT_LOCK(cow->lock + i);
       cow->array[i] = array_ll_new_init(0);
+      cow->pending[i] = NULL;
     }
 
   return cow;
@@ -94,20 +97,37 @@ copy_on_write_new(size_t num_buckets)
 }
 
 
+/* index of the first element with a key >= key (branch-free binary search) */
+static inline size_t
+cpy_array_lower_bound(array_ll_t* all, skey_t key)
+{
+  size_t n = all->size;
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  volatile kv_t* base = all->kvs;
+  while (n > 1)
+    {
+      size_t half = n >> 1;
+      base = (base[half].key < key) ? base + half : base;
+      n -= half;
+    }
+  return (base - all->kvs) + (base->key < key);
+}
+
 sval_t
 cpy_search(copy_on_write_t* set, skey_t key) 
 {
   size_t bucket = key & set->hash;
 
-  volatile array_ll_t* all_cur = set->array[bucket];
+  array_ll_t* all_cur = (array_ll_t*) set->array[bucket];
 
-  int i;
-  for (i = 0; i < all_cur->size; i++)
+  size_t i = cpy_array_lower_bound(all_cur, key);
+  if (i < all_cur->size && all_cur->kvs[i].key == key)
     {
-      if (unlikely(all_cur->kvs[i].key == key))
-	{
-	  return all_cur->kvs[i].val;
-	}
+      return all_cur->kvs[i].val;
     }
 
   return 0;
@@ -116,54 +136,89 @@ cpy_search(copy_on_write_t* set, skey_t key)
 sval_t
 cpy_array_search(array_ll_t* all_cur, skey_t key) 
 {
-  int i;
-  for (i = 0; i < all_cur->size; i++)
+  size_t i = cpy_array_lower_bound(all_cur, key);
+  return (i < all_cur->size && all_cur->kvs[i].key == key);
+}
+
+/*
+ * applies the n requests on bucket (in key order; for the same key in the
+ * order given) with a single copy of the array. Must hold the bucket lock.
+ */
+static void
+cpy_apply(copy_on_write_t* set, size_t bucket, cpy_req_t** reqs, int n)
+{
+  int r, q;
+  for (r = 1; r < n; r++)
     {
-      if (unlikely(all_cur->kvs[i].key == key))
+      cpy_req_t* req = reqs[r];
+      for (q = r; q > 0 && reqs[q - 1]->key > req->key; q--)
 	{
-	  return 1;
+	  reqs[q] = reqs[q - 1];
 	}
+      reqs[q] = req;
     }
 
-  return 0;
-}
+  array_ll_t* all_old = (array_ll_t*) set->array[bucket];
+  array_ll_t* all_new = array_ll_new(0);
 
-sval_t
-cpy_delete(copy_on_write_t* set, skey_t key)
-{
-  size_t bucket = key & set->hash;
-  array_ll_t* all_old;
-
-#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
-  all_old = (array_ll_t*) set->array[bucket];
-  if (cpy_array_search(all_old, key) == 0)
+  size_t o = 0, m = 0;
+  int changed = 0;
+  for (r = 0; r < n;)
     {
-      return 0;
-    }
-#endif
+      skey_t key = reqs[r]->key;
+      for (; o < all_old->size && all_old->kvs[o].key < key; o++, m++)
+	{
+	  all_new->kvs[m].key = all_old->kvs[o].key;
+	  all_new->kvs[m].val = all_old->kvs[o].val;
+	}
 
-  sval_t removed = 0;
+      int present = 0;
+      sval_t val = 0;
+      if (o < all_old->size && all_old->kvs[o].key == key)
+	{
+	  present = 1;
+	  val = all_old->kvs[o++].val;
+	}
 
-  GL_LOCK(set->lock);
-  LOCK(set->lock + bucket);
-  all_old = (array_ll_t*) set->array[bucket];
-  array_ll_t* all_new = array_ll_new(all_old->size - 1);
+      for (; r < n && reqs[r]->key == key; r++)
+	{
+	  cpy_req_t* req = reqs[r];
+	  if (req->insert)
+	    {
+	      req->result = !present;
+	      if (!present)
+		{
+		  present = changed = 1;
+		  val = req->val;
+		}
+	    }
+	  else
+	    {
+	      req->result = present ? val : 0;
+	      if (present)
+		{
+		  present = 0;
+		  changed = 1;
+		}
+	    }
+	}
 
-  int i, n;
-  for (i = 0, n = 0; i < all_old->size; i++, n++)
-    {
-      if (unlikely(all_old->kvs[i].key == key))
+      if (present)
 	{
-	  removed = all_old->kvs[i].val;
-	  n--;
-	  continue;
+	  all_new->kvs[m].key = key;
+	  all_new->kvs[m].val = val;
+	  m++;
 	}
+    }
 
-      all_new->kvs[n].key = all_old->kvs[i].key;
-      all_new->kvs[n].val = all_old->kvs[i].val;
+  for (; o < all_old->size; o++, m++)
+    {
+      all_new->kvs[m].key = all_old->kvs[o].key;
+      all_new->kvs[m].val = all_old->kvs[o].val;
     }
+  all_new->size = m;
 
-  if (removed)
+  if (changed)
     {
       set->array[bucket] = all_new;
       ssmem_free(alloc, (void*) all_old);
@@ -173,54 +228,93 @@ cpy_delete(copy_on_write_t* set, skey_t key)
       ssmem_free(alloc, (void*) all_new);
     }
 
-  GL_UNLOCK(set->lock);
-  UNLOCK(set->lock + bucket);
-  return removed;
+  for (r = 0; r < n; r++)
+    {
+      reqs[r]->done = 1;	/* the request (on the stack of its owner) is now gone */
+    }
 }
 
-int
-cpy_insert(copy_on_write_t* set, skey_t key, sval_t val) 
+#if CPY_ON_WRITE_BATCH == 1
+/* applies all the pending requests of bucket. Must hold the bucket lock. */
+static void
+cpy_combine(copy_on_write_t* set, size_t bucket)
 {
-  size_t bucket = key & set->hash;
-  array_ll_t* all_old;
-
-#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
-  all_old = (array_ll_t*) set->array[bucket];
-  if (cpy_array_search(all_old, key) == 1)
+  cpy_req_t* reqs[CPY_ON_WRITE_BATCH_MAX];
+  cpy_req_t* list = SWAP_PTR(&set->pending[bucket], NULL);
+  while (list != NULL)
     {
-      return 0;
+      int n = 0;
+      while (list != NULL && n < CPY_ON_WRITE_BATCH_MAX)
+	{
+	  reqs[n++] = list;
+	  list = list->next;
+	}
+      cpy_apply(set, bucket, reqs, n);
     }
+}
 #endif
 
+static sval_t
+cpy_update(copy_on_write_t* set, cpy_req_t* req)
+{
+  size_t bucket = req->key & set->hash;
+
+#if CPY_ON_WRITE_BATCH == 1
+  req->done = 0;
+  cpy_req_t* head;
+  do
+    {
+      head = set->pending[bucket];
+      req->next = head;
+    }
+  while (CAS_PTR(&set->pending[bucket], head, req) != head);
+
   GL_LOCK(set->lock);
   LOCK(set->lock + bucket);
+  /* if not done, the request is still pending: no combiner released the lock since */
+  if (!req->done)
+    {
+      cpy_combine(set, bucket);
+    }
+#else
+  GL_LOCK(set->lock);
+  LOCK(set->lock + bucket);
+  cpy_apply(set, bucket, &req, 1);
+#endif
 
-  all_old = (array_ll_t*) set->array[bucket];
-  array_ll_t* all_new = array_ll_new(all_old->size + 1);
+  GL_UNLOCK(set->lock);
+  UNLOCK(set->lock + bucket);
+  return req->result;
+}
 
-  int i;
-  for (i = 0; i < all_old->size; i++)
+sval_t
+cpy_delete(copy_on_write_t* set, skey_t key)
+{
+#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
+  size_t bucket = key & set->hash;
+  if (cpy_array_search((array_ll_t*) set->array[bucket], key) == 0)
     {
-      if (unlikely(all_old->kvs[i].key == key))
-	{
-	  ssmem_free(alloc, (void*) all_new);
-	  GL_UNLOCK(set->lock);
-	  UNLOCK(set->lock + bucket);
-	  return 0;
-	}
-      all_new->kvs[i].key = all_old->kvs[i].key;
-      all_new->kvs[i].val = all_old->kvs[i].val;
+      return 0;
     }
+#endif
 
-  all_new->kvs[i].key = key;
-  all_new->kvs[i].val = val;
-  
-  set->array[bucket] = all_new;
-  ssmem_free(alloc, (void*) all_old);
+  cpy_req_t req = { .key = key, .val = 0, .insert = 0 };
+  return cpy_update(set, &req);
+}
 
-  GL_UNLOCK(set->lock);
-  UNLOCK(set->lock + bucket);
-  return 1;
+int
+cpy_insert(copy_on_write_t* set, skey_t key, sval_t val) 
+{
+#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
+  size_t bucket = key & set->hash;
+  if (cpy_array_search((array_ll_t*) set->array[bucket], key) == 1)
+    {
+      return 0;
+    }
+#endif
+
+  cpy_req_t req = { .key = key, .val = val, .insert = 1 };
+  return cpy_update(set, &req);
 }
 
 size_t
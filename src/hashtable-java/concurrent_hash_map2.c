@@ -74,6 +74,8 @@ chm_seg_new(size_t capacity, float load_factor)
     {
       seg->size_limit = 1;
     }
+  seg->lock_acquires = 0;
+  seg->lock_contended = 0;
 
   int i;
   for (i = 0; i < seg->num_buckets; i++)
@@ -85,6 +87,17 @@ chm_seg_new(size_t capacity, float load_factor)
   return seg;
 }
 
+size_t
+chm_concurrency(size_t num_threads)
+{
+  size_t num_segments = pow2roundup(num_threads * CHM_SEGMENTS_PER_THREAD);
+  if (num_segments < CHM_NUM_SEGMENTS)
+    {
+      num_segments = CHM_NUM_SEGMENTS;
+    }
+  return num_segments;
+}
+
 chm_t*
 chm_new(size_t capacity, size_t num_segments)
 {
@@ -205,6 +218,8 @@ chm_seg_rehash(chm_t* set, int seg_num, chm_node_t* new)
   seg_new->table[new_idx] = new;
 
   seg_new->size = seg_old->size + 1;
+  seg_new->lock_acquires = seg_old->lock_acquires;
+  seg_new->lock_contended = seg_old->lock_contended;
   set->segments[seg_num] = seg_new;
 
 #if GC == 1
@@ -218,23 +233,38 @@ chm_seg_rehash(chm_t* set, int seg_num, chm_node_t* new)
  * hash table interface
  ******************************************************************************** */
 
+/*
+ * Lock-free: a resize replaces the segment and leaves the old table
+ * unchanged. A miss is validated with the segment pointer (the version of
+ * the segment), so that a get that overlaps a resize retries on the new
+ * table instead of missing the keys inserted after the resize.
+ */
 sval_t
 chm_get(chm_t* set, skey_t key)
 {
   PARSE_TRY();
 
-  chm_seg_t* seg = set->segments[key & set->hash];
-  chm_node_t** bucket = &seg->table[hash(key, set->hash_seed) & seg->hash];
-  chm_node_t* curr = *bucket;
-
-  while (curr != NULL)
+  int seg_num = key & set->hash;
+  chm_seg_t* seg = set->segments[seg_num];
+  chm_seg_t* seg_old;
+  do
     {
-      if (curr->key == key)
+      chm_node_t** bucket = &seg->table[hash(key, set->hash_seed) & seg->hash];
+      chm_node_t* curr = *bucket;
+
+      while (curr != NULL)
 	{
-	  return curr->val;
+	  if (curr->key == key)
+	    {
+	      return curr->val;
+	    }
+	  curr = curr->next;
 	}
-      curr = curr->next;
+
+      seg_old = seg;
+      COMPILER_NO_REORDER(seg = set->segments[seg_num]);
     }
+  while (unlikely(seg != seg_old));
 
   return 0;
 }
@@ -310,8 +340,10 @@ chm_put(chm_t* set, skey_t key, sval_t val)
 #endif
 
   LOCK_TRY_ONCE_CLEAR();
+  uint32_t tries = 0;
   do 
     {
+      tries++;
       seg = set->segments[seg_num];
       seg_lock = &seg->lock;
 #if CHM_TRY_PREFETCH == 1
@@ -323,6 +355,8 @@ chm_put(chm_t* set, skey_t key, sval_t val)
 #endif
     }
   while (!TRYLOCK_A(seg_lock));
+  seg->lock_acquires++;
+  seg->lock_contended += (tries > 1);
 
   chm_node_t** bucket = &seg->table[hash(key, set->hash_seed) & seg->hash];
   chm_node_t* curr = *bucket;
@@ -415,8 +449,10 @@ chm_rem(chm_t* set, skey_t key)
 #endif
 
   LOCK_TRY_ONCE_CLEAR();
+  uint32_t tries = 0;
   do 
     {
+      tries++;
       seg = set->segments[seg_num];
       seg_lock = &seg->lock;
 #if CHM_TRY_PREFETCH == 1
@@ -428,6 +464,8 @@ chm_rem(chm_t* set, skey_t key)
 #endif
     }
   while (!TRYLOCK_A(seg_lock));
+  seg->lock_acquires++;
+  seg->lock_contended += (tries > 1);
 
   chm_node_t** bucket = &seg->table[hash(key, set->hash_seed) & seg->hash];
   chm_node_t* curr = *bucket;
@@ -484,3 +522,44 @@ chm_size(chm_t* set)
 
   return size;
 }
+
+void
+chm_print_stats(chm_t* set)
+{
+  uint64_t acquires = 0, contended = 0;
+  size_t top[CHM_STATS_TOP];
+  size_t num_top = 0;
+  size_t s;
+  for (s = 0; s < set->num_segments; s++)
+    {
+      chm_seg_t* seg = set->segments[s];
+      acquires += seg->lock_acquires;
+      contended += seg->lock_contended;
+
+      /* insertion sort of the most contended segments */
+      size_t i = (num_top < CHM_STATS_TOP) ? num_top++ : CHM_STATS_TOP;
+      while (i > 0 && set->segments[top[i - 1]]->lock_contended < seg->lock_contended)
+	{
+	  if (i < CHM_STATS_TOP)
+	    {
+	      top[i] = top[i - 1];
+	    }
+	  i--;
+	}
+      if (i < CHM_STATS_TOP)
+	{
+	  top[i] = s;
+	}
+    }
+
+  printf("#segments: %zu | lock acquisitions %llu | contended %llu (%.2f%%) | avg %.1f per segment\n",
+	 set->num_segments, (unsigned long long) acquires, (unsigned long long) contended,
+	 acquires ? 100.0 * contended / acquires : 0.0, (double) acquires / set->num_segments);
+  printf("#most contended segments (id: contended / acquisitions / size):");
+  for (s = 0; s < num_top && set->segments[top[s]]->lock_contended > 0; s++)
+    {
+      chm_seg_t* seg = set->segments[top[s]];
+      printf("  %zu: %u / %u / %u", top[s], seg->lock_contended, seg->lock_acquires, seg->size);
+    }
+  printf("\n");
+}
@@ -38,6 +38,10 @@
  */
 
 #define CHM_NUM_SEGMENTS                128
+/* the default concurrency level grows with the threads beyond CHM_NUM_SEGMENTS */
+#define CHM_SEGMENTS_PER_THREAD         4
+/* the most contended segments that chm_print_stats lists */
+#define CHM_STATS_TOP                   8
 #if defined(__tile__)
 /* on the tilera we need to keep the ht small to avoid the TLB issues */
 #  define CHM_LOAD_FACTOR                 3
@@ -74,6 +78,9 @@ typedef volatile struct ALIGNED(CACHE_LINE_SIZE) chm_seg
       float load_factor;
       uint32_t size_limit;
       chm_node_t** table;
+      /* contention statistics, written under the lock */
+      uint32_t lock_acquires;
+      uint32_t lock_contended;	/* acquisitions that failed at least once */
     };
     uint8_t padding[CACHE_LINE_SIZE];
   };
@@ -99,10 +106,14 @@ typedef struct ALIGNED(CACHE_LINE_SIZE) chm
  */
 
 chm_t* chm_new(size_t capacity, size_t concurrency);
+/* the default concurrency level (number of segments) for num_threads threads */
+size_t chm_concurrency(size_t num_threads);
 sval_t chm_get(chm_t* set, skey_t key);
 int chm_put(chm_t* set, skey_t key, sval_t val);
 sval_t chm_rem(chm_t* set, skey_t key);
 size_t chm_size(chm_t* set);
+/* per-segment lock contention (not linearizable) */
+void chm_print_stats(chm_t* set);
 
 extern __thread ssmem_allocator_t* alloc;
 extern size_t maxhtlength;
@@ -69,7 +69,7 @@
 RETRY_STATS_VARS_GLOBAL;
 
 size_t initial = DEFAULT_INITIAL;
-size_t concurrency = CHM_NUM_SEGMENTS;
+size_t concurrency = 0;		/* 0: chm_concurrency(num_threads) */
 size_t range = DEFAULT_RANGE; 
 size_t load_factor = DEFAULT_LOAD;
 size_t update = DEFAULT_UPDATE;
@@ -162,6 +162,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
   barrier_cross(&barrier);
 #endif
 
@@ -205,7 +206,10 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
   
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -213,6 +217,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -249,7 +254,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   /* ssmem_term(); */
   free(alloc);
 #endif
@@ -278,6 +285,7 @@ main(int argc, char **argv)
     {"vals-pf",                   required_argument, NULL, 'f'},
     {"load-factor",               required_argument, NULL, 'l'},
     {"concurrency",               required_argument, NULL, 'c'},
+    {"stall",                     required_argument, NULL, 'S'},
     {NULL, 0, NULL, 0}
   };
 
@@ -285,7 +293,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:c:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:c:S:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -313,7 +321,7 @@ main(int argc, char **argv)
 		 "  -i, --initial-size <int>\n"
 		 "        Number of elements to insert before test\n"
 		 "  -c, --concurrency <int>\n"
-		 "        Concurrency level for the hash table\n"
+		 "        Concurrency level (number of segments) for the hash table (default: grows with -n)\n"
 		 "  -n, --num-threads <int>\n"
 		 "        Number of threads\n"
 		 "  -r, --range <int>\n"
@@ -328,6 +336,8 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -361,6 +371,9 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -381,6 +394,11 @@ main(int argc, char **argv)
       range = 2 * initial;
     }
 
+  if (concurrency == 0)
+    {
+      concurrency = chm_concurrency(num_threads);
+    }
+
   printf("## Initial: %zu / Range: %zu / Load factor: %zu / Concurrency: %zu\n", initial, range, load_factor, concurrency);
 
   double kb = initial * (sizeof(DS_NODE) + sizeof(chm_node_t*)) / 1024.0;
@@ -563,6 +581,9 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, sizeof(DS_NODE));
+  chm_print_stats(set);
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();    
@@ -106,6 +106,27 @@ ht_remove(ht_intset_t *set, skey_t key)
   return map_remove_l(&set->buckets[addr], key);
 }
 
+sval_t
+ht_put(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  return map_put_l(&set->buckets[addr], key, val);
+}
+
+sval_t
+ht_replace(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  return map_replace_l(&set->buckets[addr], key, val);
+}
+
+int
+ht_cas_value(ht_intset_t *set, skey_t key, sval_t expected, sval_t val) 
+{
+  int addr = key & set->hash;
+  return map_cas_value_l(&set->buckets[addr], key, expected, val);
+}
+
 /* 
  * Move an element in the hashtable (from one linked-list to another)
  */
@@ -54,6 +54,10 @@ ht_intset_t *ht_new();
 sval_t ht_contains(ht_intset_t* set, skey_t key);
 int ht_add(ht_intset_t* set, skey_t key, sval_t val);
 sval_t ht_remove(ht_intset_t* set, skey_t key);
+/* in-place updates (see lists/set-optik.h) */
+sval_t ht_put(ht_intset_t* set, skey_t key, sval_t val);
+sval_t ht_replace(ht_intset_t* set, skey_t key, sval_t val);
+int ht_cas_value(ht_intset_t* set, skey_t key, sval_t expected, sval_t val);
 
 /* 
  * Move an element in the hashtable (from one linked-list to another)
@@ -41,3 +41,21 @@ map_remove_l(map_t* map, skey_t key)
 {
   return optik_map_remove(map, key);
 }
+
+sval_t
+map_put_l(map_t* map, skey_t key, sval_t val)
+{
+  return optik_map_put(map, key, val);
+}
+
+sval_t
+map_replace_l(map_t* map, skey_t key, sval_t val)
+{
+  return optik_map_replace(map, key, val);
+}
+
+int
+map_cas_value_l(map_t* map, skey_t key, sval_t expected, sval_t val)
+{
+  return optik_map_cas_value(map, key, expected, val);
+}
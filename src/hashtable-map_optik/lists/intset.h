@@ -26,3 +26,6 @@
 sval_t map_contains_l(map_t *map, skey_t key);
 int map_add_l(map_t *map, skey_t key, sval_t val);
 sval_t map_remove_l(map_t *map, skey_t key);
+sval_t map_put_l(map_t *map, skey_t key, sval_t val);
+sval_t map_replace_l(map_t *map, skey_t key, sval_t val);
+int map_cas_value_l(map_t *map, skey_t key, sval_t expected, sval_t val);
@@ -115,3 +115,78 @@ optik_map_remove(map_t* map, skey_t key)
 
   return 0;
 }
+
+/*
+ * writes val to the entry of key if its value is expected (or if expected is
+ * 0), or inserts key if it is not in the map and insert is set; returns the
+ * previous value (0 if key was not in the map). The write changes the version
+ * of the map, as contains validates the value it reads.
+ */
+static inline sval_t
+optik_map_update(map_t* map, skey_t key, sval_t val, sval_t expected, int insert)
+{
+  optik_t version;
+ restart:
+  COMPILER_NO_REORDER(version = optik_get_version_wait(&map->lock));
+  int free_idx = -1;
+  int i;
+  for (i = 0; i < map->size; i++)
+    {
+      skey_t ck = map->array[i].key;
+      if (ck == key)
+	{
+	  if (!optik_trylock_version(&map->lock, version))
+	    {
+	      goto restart;
+	    }
+	  sval_t val_old = map->array[i].val;
+	  if (expected == 0 || val_old == expected)
+	    {
+	      map->array[i].val = val;
+	    }
+	  optik_unlock(&map->lock);
+	  return val_old;
+	}
+      else if (ck == 0)
+	{
+	  free_idx = i;
+	}
+    }
+
+  if (!insert)
+    {
+      return 0;
+    }
+  if (free_idx < 0)
+    {
+      return OPTIK_MAP_FULL;
+    }
+
+  if (!optik_trylock_version(&map->lock, version))
+    {
+      goto restart;
+    }
+
+  map->array[free_idx].key = key;
+  map->array[free_idx].val = val;
+  optik_unlock(&map->lock);
+  return 0;
+}
+
+sval_t
+optik_map_put(map_t* map, skey_t key, sval_t val)
+{
+  return optik_map_update(map, key, val, 0, 1);
+}
+
+sval_t
+optik_map_replace(map_t* map, skey_t key, sval_t val)
+{
+  return optik_map_update(map, key, val, 0, 0);
+}
+
+int
+optik_map_cas_value(map_t* map, skey_t key, sval_t expected, sval_t val)
+{
+  return (expected != 0 && optik_map_update(map, key, val, expected, 0) == expected);
+}
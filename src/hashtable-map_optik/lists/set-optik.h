@@ -34,5 +34,12 @@
 sval_t optik_map_contains(map_t* map, skey_t key);
 int optik_map_insert(map_t* map, skey_t key, sval_t val);
 sval_t optik_map_remove(map_t* map, skey_t key);
+/* in-place updates: put returns the previous value (0 if it inserted, or
+   OPTIK_MAP_FULL), replace the previous value (0 if key is not in the map),
+   cas_value 1 on success */
+#define OPTIK_MAP_FULL ((sval_t) -1)
+sval_t optik_map_put(map_t* map, skey_t key, sval_t val);
+sval_t optik_map_replace(map_t* map, skey_t key, sval_t val);
+int optik_map_cas_value(map_t* map, skey_t key, sval_t expected, sval_t val);
 
 #endif	/* _H_LAZY_ */
@@ -48,13 +48,18 @@
 #endif
 
 #include "hashtable-lock.h"
+/* a put into a full bucket */
+#define IN_PLACE_PUT_FULL OPTIK_MAP_FULL
+#include "in_place.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
  * ################################################################### */
 
 #define DS_CONTAINS(s,k,t)  ht_contains(s, k)
-#define DS_ADD(s,k,t)       ht_add(s, k, k)
+/* with -U, inserts rotate over put, replace, and cas_value (see in_place.h) */
+#define DS_ADD(s,k,t)       (in_place ? IN_PLACE_ADD(s, k, ht_put, ht_replace, ht_cas_value, ht_contains) \
+                             : ht_add(s, k, k))
 #define DS_REMOVE(s,k,t)    ht_remove(s, k)
 #define DS_SIZE(s)          ht_size(s)
 #define DS_NEW()            ht_new()
@@ -74,6 +79,8 @@ size_t load_factor = DEFAULT_LOAD;
 size_t update = DEFAULT_UPDATE;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+int in_place = 0;
+IN_PLACE_VARS_DEFINITION();
 
 size_t print_vals_num = 100; 
 size_t pf_vals_num = 1023;
@@ -161,6 +168,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
 
   RR_INIT(phys_id);
@@ -192,6 +200,7 @@ test(void* thread)
 	  i--;
 	}
     }
+  in_place_start();
   MEM_BARRIER;
 
   barrier_cross(&barrier);
@@ -204,7 +213,10 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -212,6 +224,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -239,6 +252,7 @@ test(void* thread)
   putting_count_succ[ID] += my_putting_count_succ;
   getting_count_succ[ID] += my_getting_count_succ;
   removing_count_succ[ID]+= my_removing_count_succ;
+  in_place_publish();
 
   OPTIK_STATS_PUBLISH();
 
@@ -250,7 +264,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -263,6 +279,7 @@ OPTIK_STATS_VARS_DEFINITION();
 int
 main(int argc, char **argv) 
 {
+  BACKOFF_INIT();
   set_cpu(0);
   ssalloc_init();
   seeds = seed_rand();
@@ -279,6 +296,8 @@ main(int argc, char **argv)
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
     {"load-factor",               required_argument, NULL, 'l'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {"in-place",                  no_argument,       NULL, 'U'},
     {NULL, 0, NULL, 0}
   };
 
@@ -286,7 +305,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:S:U", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -327,6 +346,10 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 "  -U, --in-place\n"
+		 "        Inserts rotate over put, replace, and cas_value (in-place updates of present keys)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -357,6 +380,12 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case 'U':
+	  in_place = 1;
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -563,10 +592,16 @@ main(int argc, char **argv)
 	 (LLU) putting_count_total_succ, putting_perc_succ, putting_perc, (putting_perc * putting_perc_succ) / 100);
   printf("rems: %-10llu | %-10llu | %10.1f%% | %10.1f%% | %10.1f%%\n", (LLU) removing_count_total, 
 	 (LLU) removing_count_total_succ, removing_perc_succ, removing_perc, (removing_perc * removing_perc_succ) / 100);
+  if (in_place)
+    {
+      in_place_print();
+    }
 
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, sizeof(DS_NODE));
 
   OPTIK_STATS_PRINT();
 
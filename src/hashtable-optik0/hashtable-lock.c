@@ -43,6 +43,7 @@ ht_delete(ht_intset_t *set)
 	  node = next;
 	}
     }
+  SIZE_COUNTER_FREE(set->sizes);
   free(set);
 }
 
@@ -65,6 +66,35 @@ ht_size(ht_intset_t *set)
   return size;
 }
 
+/* O(threads) with SIZE_COUNTERS (see size_counter.h), a traversal otherwise */
+size_t
+ht_size_approx(ht_intset_t* set)
+{
+#if SIZE_COUNTERS == 1
+  return size_counter_read(set->sizes);
+#else
+  return ht_size(set);
+#endif
+}
+
+/* bytes of the table, the buckets, and all the nodes */
+size_t
+ht_memory(ht_intset_t* set)
+{
+  size_t nodes = 0;
+  node_l_t* node;
+  int i;
+
+  for (i = 0; i < maxhtlength; i++)
+    {
+      for (node = set->buckets[i].head; node != NULL; node = (node_l_t*) node->next)
+	{
+	  nodes++;
+	}
+    }
+  return sizeof(ht_intset_t) + (maxhtlength + 1) * sizeof(intset_l_t) + nodes * sizeof(node_l_t);
+}
+
 int
 floor_log_2(unsigned int n) 
 {
@@ -90,6 +120,7 @@ ht_new()
     }   
 
   set->hash = maxhtlength - 1;
+  set->sizes = SIZE_COUNTER_NEW();
 
   size_t bs = (maxhtlength + 1) * sizeof(intset_l_t);
   bs += CACHE_LINE_SIZE - (bs & CACHE_LINE_SIZE);
@@ -117,14 +148,41 @@ int
 ht_add(ht_intset_t *set, skey_t key, sval_t val) 
 {
   int addr = key & set->hash;
-  return set_add_l(&set->buckets[addr], key, val);
+  int ret = set_add_l(&set->buckets[addr], key, val);
+  SIZE_COUNTER_INC(set->sizes, ret);
+  return ret;
 }
 
 sval_t
 ht_remove(ht_intset_t *set, skey_t key) 
 {
   int addr = key & set->hash;
-  return set_remove_l(&set->buckets[addr], key);
+  sval_t ret = set_remove_l(&set->buckets[addr], key);
+  SIZE_COUNTER_DEC(set->sizes, ret != 0);
+  return ret;
+}
+
+sval_t
+ht_put(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  sval_t ret = set_put_l(&set->buckets[addr], key, val);
+  SIZE_COUNTER_INC(set->sizes, ret == 0);
+  return ret;
+}
+
+sval_t
+ht_replace(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  return set_replace_l(&set->buckets[addr], key, val);
+}
+
+int
+ht_cas_value(ht_intset_t *set, skey_t key, sval_t expected, sval_t val) 
+{
+  int addr = key & set->hash;
+  return set_cas_value_l(&set->buckets[addr], key, expected, val);
 }
 
 /* 
@@ -43,17 +43,24 @@ typedef struct ht_intset
 {
   size_t hash;
   intset_l_t* buckets;
-  uint8_t padding[CACHE_LINE_SIZE - sizeof(size_t) - sizeof(intset_l_t*)];
+  size_counter_t* sizes;	/* with SIZE_COUNTERS */
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(size_t) - sizeof(intset_l_t*) - sizeof(size_counter_t*)];
 } ht_intset_t;
 
 
 void ht_delete(ht_intset_t *set);
 int ht_size(ht_intset_t *set);
+size_t ht_size_approx(ht_intset_t* set);
+size_t ht_memory(ht_intset_t* set);
 int floor_log_2(unsigned int n);
 ht_intset_t *ht_new();
 sval_t ht_contains(ht_intset_t* set, skey_t key);
 int ht_add(ht_intset_t* set, skey_t key, sval_t val);
 sval_t ht_remove(ht_intset_t* set, skey_t key);
+/* in-place updates (see lists/intset.h) */
+sval_t ht_put(ht_intset_t* set, skey_t key, sval_t val);
+sval_t ht_replace(ht_intset_t* set, skey_t key, sval_t val);
+int ht_cas_value(ht_intset_t* set, skey_t key, sval_t expected, sval_t val);
 
 /* 
  * Move an element in the hashtable (from one linked-list to another)
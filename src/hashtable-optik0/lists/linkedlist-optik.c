@@ -168,3 +168,117 @@ optik_delete(intset_l_t *set, skey_t key)
 
   return result;
 }
+
+/*
+ * writes val to the node of key if its value is expected (or if expected is
+ * 0), or inserts key if it is not in the list and insert is set; returns the
+ * previous value (0 if key was not in the list)
+ */
+static inline sval_t
+optik_update(intset_l_t *set, skey_t key, sval_t val, sval_t expected, int insert)
+{
+  node_l_t *pred, *curr;
+  optik_t pred_ver = OPTIK_INIT;
+  OPTIK_WITHOUT_GL_DO(optik_t curr_ver = OPTIK_INIT;);
+  sval_t result = 0;
+
+ restart:
+  PARSE_TRY();
+
+  curr = set->head;
+  OPTIK_WITHOUT_GL_DO(curr_ver = curr->lock;);
+  OPTIK_WITH_GL_DO(COMPILER_NO_REORDER(pred_ver = set->lock));
+
+  do
+    {
+      pred = curr;
+      OPTIK_WITHOUT_GL_DO(pred_ver = curr_ver;);
+
+      curr = curr->next;
+      if (curr == NULL)
+	{
+	  break;
+	}
+      OPTIK_WITHOUT_GL_DO(curr_ver = curr->lock;);
+    }
+  while (curr->key < key);
+
+  UPDATE_TRY();
+
+  if (curr == NULL || curr->key != key)
+    {
+      if (!insert)
+	{
+	  return 0;
+	}
+
+      OPTIK_WITHOUT_GL_DO(
+			  if ((!optik_trylock_version(&pred->lock, pred_ver)))
+			    {
+			      goto restart;
+			    }
+			  );
+
+      OPTIK_WITH_GL_DO(
+		       if ((!optik_trylock_version(&set->lock, pred_ver)))
+			 {
+			   goto restart;
+			 }
+		       );
+
+      node_l_t* newnode = new_node_l(key, val, curr, 0);
+#ifdef __tile__
+      MEM_BARRIER;
+#endif
+      pred->next = newnode;
+
+      OPTIK_WITHOUT_GL_DO(optik_unlock(&pred->lock););
+      OPTIK_WITH_GL_DO(optik_unlock(&set->lock););
+      return 0;
+    }
+
+  /* a deleted node stays locked, so the lock of curr excludes its delete */
+  OPTIK_WITHOUT_GL_DO(
+		      if (unlikely(!optik_trylock_version(&curr->lock, curr_ver)))
+			{
+			  goto restart;
+			}
+		      );
+
+  OPTIK_WITH_GL_DO(
+		   if ((!optik_trylock_version(&set->lock, pred_ver)))
+		     {
+		       goto restart;
+		     }
+		   );
+
+  result = curr->val;
+  if (expected == 0 || result == expected)
+    {
+      curr->val = val;
+    }
+
+  /* the links did not change: keep the version */
+  OPTIK_WITHOUT_GL_DO(optik_revert(&curr->lock););
+  OPTIK_WITH_GL_DO(optik_revert(&set->lock););
+
+  return result;
+}
+
+sval_t
+optik_put(intset_l_t *set, skey_t key, sval_t val)
+{
+  return optik_update(set, key, val, 0, 1);
+}
+
+sval_t
+optik_replace(intset_l_t *set, skey_t key, sval_t val)
+{
+  return optik_update(set, key, val, 0, 0);
+}
+
+int
+optik_cas_value(intset_l_t *set, skey_t key, sval_t expected, sval_t val)
+{
+  return (expected != 0 && optik_update(set, key, val, expected, 0) == expected);
+}
@@ -36,5 +36,10 @@ extern int optik_validate(node_l_t* pred, node_l_t* curr);
 sval_t optik_find(intset_l_t* set, skey_t key);
 int optik_insert(intset_l_t* set, skey_t key, sval_t val);
 sval_t optik_delete(intset_l_t* set, skey_t key);
+/* in-place updates: put returns the previous value (0 if it inserted), replace
+   the previous value (0 if key is not in the list), cas_value 1 on success */
+sval_t optik_put(intset_l_t* set, skey_t key, sval_t val);
+sval_t optik_replace(intset_l_t* set, skey_t key, sval_t val);
+int optik_cas_value(intset_l_t* set, skey_t key, sval_t expected, sval_t val);
 
 #endif	/* _H_LL_OPTIK_ */
@@ -48,19 +48,30 @@
 #endif
 
 #include "hashtable-lock.h"
+#include "shard.h"
+#include "in_place.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
  * ################################################################### */
 
-#define DS_CONTAINS(s,k,t)  ht_contains(s, k)
-#define DS_ADD(s,k,t)       ht_add(s, k, k)
-#define DS_REMOVE(s,k,t)    ht_remove(s, k)
-#define DS_SIZE(s)          ht_size(s)
-#define DS_NEW()            ht_new()
+#define DS_CONTAINS_LOCAL(s,k,t) ht_contains(s, k)
+/* with -U, inserts rotate over put, replace, and cas_value (see in_place.h) */
+#define DS_ADD_LOCAL(s,k,t)      (in_place ? IN_PLACE_ADD(s, k, ht_put, ht_replace, ht_cas_value, ht_contains) \
+                                  : ht_add(s, k, k))
+#define DS_REMOVE_LOCAL(s,k,t)   ht_remove(s, k)
+
+/* with -P, on the shard of the key (see shard.h) */
+#define DS_CONTAINS(s,k,t)       SHARD_OP(s, k, t, DS_CONTAINS_LOCAL)
+#define DS_ADD(s,k,t)            SHARD_OP(s, k, t, DS_ADD_LOCAL)
+#define DS_REMOVE(s,k,t)         SHARD_OP(s, k, t, DS_REMOVE_LOCAL)
+#define DS_SIZE(s)               SHARD_SUM(s, ht_size)
+#define DS_SIZE_APPROX(s)        SHARD_SUM(s, ht_size_approx)
+#define DS_NEW()                 ht_new()
 
 #define DS_TYPE             ht_intset_t
 #define DS_NODE             node_l_t
+#define DS_MEMORY(s)        SHARD_SUM(s, ht_memory)
 
 /* ################################################################### *
  * GLOBALS
@@ -74,6 +85,11 @@ size_t load_factor = DEFAULT_LOAD;
 size_t update = DEFAULT_UPDATE;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+int in_place = 0;
+IN_PLACE_VARS_DEFINITION();
+size_t num_shards = 0;
+int shard_policy = SHARD_HASH;
+int shard_affinity = 0;
 
 size_t print_vals_num = 100; 
 size_t pf_vals_num = 1023;
@@ -81,6 +97,7 @@ size_t put, put_explicit = false;
 double update_rate, put_rate, get_rate;
 
 size_t size_after = 0;
+size_t memory_after = 0;
 int seed = 0;
 __thread unsigned long * seeds;
 uint32_t rand_max;
@@ -88,6 +105,7 @@ uint32_t rand_max;
 
 static volatile int stop;
 TEST_VARS_GLOBAL;
+SHARD_VARS_DEFINITION();
 
 volatile ticks *putting_succ;
 volatile ticks *putting_fail;
@@ -161,6 +179,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
 
   RR_INIT(phys_id);
@@ -182,6 +201,26 @@ test(void* thread)
 #if INITIALIZE_FROM_ONE == 1
   num_elems_thread = (ID == 0) * initial;
 #endif
+
+  if (__shards.num)
+    {
+      /* the threads of a node fill the shards of the node */
+      uint32_t sh;
+      for (sh = 0; sh < __shards.num; sh++)
+	{
+	  size_t n = shard_fill_count(&__shards, sh, ID, num_threads);
+	  for(i = 0; i < n; i++)
+	    {
+	      key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
+	      key = shard_key_of(&__shards, sh, key);
+	      if(shard_of(&__shards, key) != sh || DS_ADD(set, key, NULL) == false)
+		{
+		  i--;
+		}
+	    }
+	}
+      num_elems_thread = 0;
+    }
     
   for(i = 0; i < num_elems_thread; i++) 
     {
@@ -192,6 +231,7 @@ test(void* thread)
 	  i--;
 	}
     }
+  in_place_start();
   MEM_BARRIER;
 
   barrier_cross(&barrier);
@@ -200,11 +240,16 @@ test(void* thread)
     {
       printf("#BEFORE size is: %zu\n", (size_t) DS_SIZE(set));
     }
+  /* the initial keys are spread over all the shards */
+  shard_thread_home(&__shards, ID);
 
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -212,6 +257,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -219,7 +265,16 @@ test(void* thread)
   if (!ID)
     {
       size_after = DS_SIZE(set);
+      memory_after = DS_MEMORY(set);
       printf("#AFTER  size is: %zu\n", size_after);
+#if SIZE_COUNTERS == 1
+      size_t size_approx = DS_SIZE_APPROX(set);
+      printf("#AFTER  size (counters): %zu\n", size_approx);
+      if (size_approx != size_after)
+	{
+	  printf("// WRONG size counters. %zu != %zu\n", size_approx, size_after);
+	}
+#endif
     }
 
   barrier_cross(&barrier);
@@ -239,6 +294,7 @@ test(void* thread)
   putting_count_succ[ID] += my_putting_count_succ;
   getting_count_succ[ID] += my_getting_count_succ;
   removing_count_succ[ID]+= my_removing_count_succ;
+  in_place_publish();
 
   EXEC_IN_DEC_ID_ORDER(ID, num_threads)
     {
@@ -248,7 +304,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -275,6 +333,11 @@ main(int argc, char **argv)
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
     {"load-factor",               required_argument, NULL, 'l'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {"in-place",                  no_argument,       NULL, 'U'},
+    {"shards",                    required_argument, NULL, 'P'},
+    {"shard-range",               no_argument,       NULL, 'R'},
+    {"shard-affinity",            no_argument,       NULL, 'L'},
     {NULL, 0, NULL, 0}
   };
 
@@ -282,7 +345,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:S:UP:RL", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -323,6 +386,16 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 "  -U, --in-place\n"
+		 "        Inserts rotate over put, replace, and cas_value (in-place updates of present keys)\n"
+		 "  -P, --shards <int>\n"
+		 "        Partition the keys (by hash) over <int> instances spread over the NUMA nodes\n"
+		 "  -R, --shard-range\n"
+		 "        Partition the keys by range (with -P)\n"
+		 "  -L, --shard-affinity\n"
+		 "        Every thread uses only the keys of a shard on its node (with -P)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -353,6 +426,21 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case 'U':
+	  in_place = 1;
+	  break;
+	case 'P':
+	  num_shards = atoi(optarg);
+	  break;
+	case 'R':
+	  shard_policy = SHARD_RANGE;
+	  break;
+	case 'L':
+	  shard_affinity = 1;
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -423,8 +511,24 @@ main(int argc, char **argv)
   stop = 0;
     
   maxhtlength = (unsigned int) initial / load_factor;
+  if (num_shards > 0)
+    {
+      /* the shards share the buckets */
+      maxhtlength = (maxhtlength > num_shards) ? pow2roundup(maxhtlength / num_shards) : 1;
+    }
 
-  DS_TYPE* set = DS_NEW();
+  DS_TYPE* set;
+  if (num_shards > 0)
+    {
+      shard_init(&__shards, num_shards, shard_policy, shard_affinity, rand_min, rand_max + 1,
+		 initial, (shard_new_t) ht_new);
+      shard_print(&__shards);
+      set = (DS_TYPE*) __shards.set[0];
+    }
+  else
+    {
+      set = DS_NEW();
+    }
   assert(set != NULL);
 
   /* Initializes the local data */
@@ -556,10 +660,16 @@ main(int argc, char **argv)
 	 (LLU) putting_count_total_succ, putting_perc_succ, putting_perc, (putting_perc * putting_perc_succ) / 100);
   printf("rems: %-10llu | %-10llu | %10.1f%% | %10.1f%% | %10.1f%%\n", (LLU) removing_count_total, 
 	 (LLU) removing_count_total_succ, removing_perc_succ, removing_perc, (removing_perc * removing_perc_succ) / 100);
+  if (in_place)
+    {
+      in_place_print();
+    }
 
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(memory_after, size_after, sizeof(DS_NODE));
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();    
@@ -82,6 +82,24 @@ ht_print(ht_intset_t* set)
     }
 }
 
+/* bytes of the table, the buckets, and all the nodes */
+size_t
+ht_memory(ht_intset_t* set)
+{
+  size_t nodes = 0;
+  node_l_t* node;
+  int i;
+
+  for (i = 0; i < maxhtlength; i++)
+    {
+      for (node = set->buckets[i].head; node != NULL; node = (node_l_t*) node->next)
+	{
+	  nodes++;
+	}
+    }
+  return sizeof(ht_intset_t) + (maxhtlength + 1) * sizeof(intset_l_t) + nodes * sizeof(node_l_t);
+}
+
 int
 floor_log_2(unsigned int n) 
 {
@@ -144,71 +162,198 @@ ht_remove(ht_intset_t *set, skey_t key)
   return set_remove_l(&set->buckets[addr], key);
 }
 
+sval_t
+ht_put(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  return set_put_l(&set->buckets[addr], key, val);
+}
+
+sval_t
+ht_replace(ht_intset_t *set, skey_t key, sval_t val) 
+{
+  int addr = key & set->hash;
+  return set_replace_l(&set->buckets[addr], key, val);
+}
+
+int
+ht_cas_value(ht_intset_t *set, skey_t key, sval_t expected, sval_t val) 
+{
+  int addr = key & set->hash;
+  return set_cas_value_l(&set->buckets[addr], key, expected, val);
+}
+
 /* 
  * Move an element in the hashtable (from one linked-list to another)
  */
+
+__thread size_t ht_move_aborts = 0;
+
+/* traverse a bucket: on return, curr is the first node with key >= key and
+   pred its predecessor (NULL if curr is the head) */
+static inline node_l_t*
+ht_bucket_search(intset_l_t* bucket, skey_t key, node_l_t** pred)
+{
+  node_l_t* p = NULL;
+  node_l_t* curr = bucket->head;
+  while (curr != NULL && curr->key < key)
+    {
+      p = curr;
+      curr = (node_l_t*) curr->next;
+    }
+  *pred = p;
+  return curr;
+}
+
+static inline void
+ht_bucket_link(intset_l_t* bucket, node_l_t* pred, node_l_t* node)
+{
+  if (pred != NULL)
+    {
+      pred->next = node;
+    }
+  else
+    {
+      bucket->head = node;
+    }
+}
+
+/* 
+ * OPTIK-validates and locks the two buckets with the versions observed
+ * before the traversals. Both are trylocks, so no global lock order is
+ * needed to avoid deadlocks. 
+ */
+static inline int
+ht_trylock_buckets(intset_l_t* b1, optik_t v1, intset_l_t* b2, optik_t v2)
+{
+  if (!optik_trylock_version(&b1->lock, v1))
+    {
+      return 0;
+    }
+  if (b1 != b2 && !optik_trylock_version(&b2->lock, v2))
+    {
+      optik_revert(&b1->lock);
+      return 0;
+    }
+  return 1;
+}
+
+static inline void
+ht_unlock_buckets(intset_l_t* b1, intset_l_t* b2)
+{
+  if (b1 != b2)
+    {
+      optik_unlock(&b2->lock);
+    }
+  optik_unlock(&b1->lock);
+}
+
+/* 
+ * Atomically removes key_from from set_from and inserts it (with the same
+ * value) as key_to in set_to. The two sets can be the same hash table.
+ * Fails (returns 0) if key_from is not in set_from or key_to is already in
+ * set_to. The move is atomic w.r.t. all other updates: the versions of both
+ * buckets are validated together before any modification. Wait-free
+ * ht_contains calls can observe the element in both buckets (never in none)
+ * while the move is in progress.
+ */
 int
-ht_move(ht_intset_t *set, int val1, int val2) 
+ht_move(ht_intset_t* set_from, skey_t key_from, ht_intset_t* set_to, skey_t key_to)
 {
-  int result = 0;
-  /* node_l_t *pred1, *curr1, *curr2, *pred2, *newnode; */
-  /* int addr1, addr2, result = 0; */
-	
-/* #ifdef DEBUG */
-/*   printf("++> ht_move(%d, %d)\n", (int) val1, (int) val2); */
-/*   IO_FLUSH; */
-/* #endif */
-	
-/*   if (val1 == val2) return 0; */
-	
-/*   // records pred and succ of val1 */
-/*   addr1 = val1 % maxhtlength; */
-/*   pred1 = set->buckets[addr1]->head; */
-/*   curr1 = pred1->next; */
-/*   while (curr1->val < val1) { */
-/*     pred1 = curr1; */
-/*     curr1 = curr1->next; */
-/*   } */
-/*   // records pred and succ of val2  */
-/*   addr2 = val2 % maxhtlength; */
-/*   pred2 = set->buckets[addr2]->head; */
-/*   curr2 = pred2->next; */
-/*   while (curr2->val < val2) { */
-/*     pred2 = curr2; */
-/*     curr2 = curr2->next; */
-/*   } */
-/*   // unnecessary move */
-/*   if (pred1->val == pred2->val || curr1->val == pred2->val ||  */
-/*       curr2->val == pred1->val || curr1->val == curr2->val)  */
-/*     return 0; */
-/*   // acquire locks in order */
-/*   if (addr1 < addr2 || (addr1 == addr2 && val1 < val2)) { */
-/*     LOCK(ND_GET_LOCK(pred1)); */
-/*     LOCK(ND_GET_LOCK(curr1)); */
-/*     LOCK(ND_GET_LOCK(pred2)); */
-/*     LOCK(ND_GET_LOCK(curr2)); */
-/*   } else { */
-/*     LOCK(ND_GET_LOCK(pred2)); */
-/*     LOCK(ND_GET_LOCK(curr2)); */
-/*     LOCK(ND_GET_LOCK(pred1)); */
-/*     LOCK(ND_GET_LOCK(curr1)); */
-/*   } */
-/*   // remove val1 and insert val2  */
-/*   result = (parse_validate(pred1, curr1) && (val1 == curr1->val) && */
-/* 	    parse_validate(pred2, curr2) && (curr2->val != val2)); */
-/*   if (result) { */
-/*     set_mark((uintptr_t*) &curr1->next); */
-/*     pred1->next = curr1->next; */
-/*     newnode = new_node_l(val2, val2, curr2, 0); */
-/*     pred2->next = newnode; */
-/*   } */
-/*   // release locks in order */
-/*   UNLOCK(ND_GET_LOCK(pred2)); */
-/*   UNLOCK(ND_GET_LOCK(pred1)); */
-/*   UNLOCK(ND_GET_LOCK(curr2)); */
-/*   UNLOCK(ND_GET_LOCK(curr1)); */
-		
-  return result;
+  intset_l_t* b1 = &set_from->buckets[key_from & set_from->hash];
+  intset_l_t* b2 = &set_to->buckets[key_to & set_to->hash];
+  node_l_t *pred1, *curr1, *pred2, *curr2;
+
+  if (b1 == b2 && key_from == key_to)
+    {
+      return 0;
+    }
+
+ restart:
+  PARSE_TRY();
+  COMPILER_NO_REORDER(optik_t v1 = b1->lock;
+		      optik_t v2 = b2->lock;);
+
+  curr1 = ht_bucket_search(b1, key_from, &pred1);
+  if (curr1 == NULL || curr1->key != key_from)
+    {
+      return 0;
+    }
+
+  curr2 = ht_bucket_search(b2, key_to, &pred2);
+  if (curr2 != NULL && curr2->key == key_to)
+    {
+      return 0;
+    }
+
+  UPDATE_TRY();
+  if (!ht_trylock_buckets(b1, v1, b2, v2))
+    {
+      ht_move_aborts++;
+      goto restart;
+    }
+
+  node_l_t* newnode = new_node_l(key_to, curr1->val, curr2, 0);
+#ifdef __tile__
+  MEM_BARRIER;
+#endif
+  ht_bucket_link(b2, pred2, newnode);
+
+  if (b1 == b2 && pred1 == pred2 && key_to < key_from)
+    {
+      pred1 = newnode;		/* the new node was linked right before curr1 */
+    }
+  ht_bucket_link(b1, pred1, (node_l_t*) curr1->next);
+
+  ht_unlock_buckets(b1, b2);
+
+#if GC == 1
+  ssmem_free(alloc, (void*) curr1);
+#endif
+  return 1;
+}
+
+/* 
+ * Atomically swaps the values of key1 in set1 and key2 in set2. Fails if
+ * any of the two keys is missing.
+ */
+int
+ht_swap(ht_intset_t* set1, skey_t key1, ht_intset_t* set2, skey_t key2)
+{
+  intset_l_t* b1 = &set1->buckets[key1 & set1->hash];
+  intset_l_t* b2 = &set2->buckets[key2 & set2->hash];
+  node_l_t *pred, *curr1, *curr2;
+
+ restart:
+  PARSE_TRY();
+  COMPILER_NO_REORDER(optik_t v1 = b1->lock;
+		      optik_t v2 = b2->lock;);
+
+  curr1 = ht_bucket_search(b1, key1, &pred);
+  if (curr1 == NULL || curr1->key != key1)
+    {
+      return 0;
+    }
+
+  curr2 = ht_bucket_search(b2, key2, &pred);
+  if (curr2 == NULL || curr2->key != key2)
+    {
+      return 0;
+    }
+
+  UPDATE_TRY();
+  if (!ht_trylock_buckets(b1, v1, b2, v2))
+    {
+      ht_move_aborts++;
+      goto restart;
+    }
+
+  sval_t tmp = curr1->val;
+  curr1->val = curr2->val;
+  curr2->val = tmp;
+
+  ht_unlock_buckets(b1, b2);
+  return 1;
 }
 
 /* 
@@ -49,16 +49,28 @@ typedef struct ht_intset
 
 void ht_delete(ht_intset_t *set);
 int ht_size(ht_intset_t *set);
+size_t ht_memory(ht_intset_t* set);
 int floor_log_2(unsigned int n);
 ht_intset_t *ht_new();
 sval_t ht_contains(ht_intset_t* set, skey_t key);
 int ht_add(ht_intset_t* set, skey_t key, sval_t val);
 sval_t ht_remove(ht_intset_t* set, skey_t key);
+/* in-place updates (see lists/intset.h) */
+sval_t ht_put(ht_intset_t* set, skey_t key, sval_t val);
+sval_t ht_replace(ht_intset_t* set, skey_t key, sval_t val);
+int ht_cas_value(ht_intset_t* set, skey_t key, sval_t expected, sval_t val);
 
 /* 
- * Move an element in the hashtable (from one linked-list to another)
+ * Atomically move an element from one bucket to another (possibly of a
+ * different hash table), using OPTIK validation of both buckets
  */
-int ht_move(ht_intset_t *set, int val1, int val2);
+int ht_move(ht_intset_t* set_from, skey_t key_from, ht_intset_t* set_to, skey_t key_to);
+/* 
+ * Atomically swap the values of two keys (possibly of different tables)
+ */
+int ht_swap(ht_intset_t* set1, skey_t key1, ht_intset_t* set2, skey_t key2);
+/* number of failed (validation) lock attempts of ht_move/ht_swap */
+extern __thread size_t ht_move_aborts;
 /* 
  * Read all elements of the hashtable (parses all linked-lists)
  * This cannot be consistent when used with move operation.
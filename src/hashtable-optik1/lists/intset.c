@@ -41,3 +41,21 @@ set_remove_l(intset_l_t* set, skey_t key)
 {
   return optik_delete(set, key);
 }
+
+sval_t
+set_put_l(intset_l_t* set, skey_t key, sval_t val)
+{
+  return optik_put(set, key, val);
+}
+
+sval_t
+set_replace_l(intset_l_t* set, skey_t key, sval_t val)
+{
+  return optik_replace(set, key, val);
+}
+
+int
+set_cas_value_l(intset_l_t* set, skey_t key, sval_t expected, sval_t val)
+{
+  return optik_cas_value(set, key, expected, val);
+}
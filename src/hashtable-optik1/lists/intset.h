@@ -26,3 +26,6 @@
 sval_t set_contains_l(intset_l_t *set, skey_t key);
 int set_add_l(intset_l_t *set, skey_t key, sval_t val);
 sval_t set_remove_l(intset_l_t *set, skey_t key);
+sval_t set_put_l(intset_l_t *set, skey_t key, sval_t val);
+sval_t set_replace_l(intset_l_t *set, skey_t key, sval_t val);
+int set_cas_value_l(intset_l_t *set, skey_t key, sval_t expected, sval_t val);
@@ -251,3 +251,156 @@ optik_delete(intset_l_t *set, skey_t key)
   return result;
 }
 #endif	/* LL_GLOBAL_LOCK */
+
+/*
+ * writes val to the node of key if its value is expected (or if expected is
+ * 0), or inserts key if it is not in the list and insert is set; returns the
+ * previous value (0 if key was not in the list)
+ */
+#if !defined(LL_GLOBAL_LOCK)
+static inline sval_t
+optik_update(intset_l_t *set, skey_t key, sval_t val, sval_t expected, int insert)
+{
+ restart:
+  PARSE_TRY();
+  volatile node_l_t *curr, *pred = NULL;
+
+  COMPILER_NO_REORDER(optik_t pred_ver = set->lock);
+  curr = set->head;
+
+  while (curr != NULL && (curr->key < key))
+    {
+      pred = curr;
+      curr = curr->next;
+    }
+
+  UPDATE_TRY();
+
+  int found = (curr != NULL && curr->key == key);
+  if (!found && !insert)
+    {
+      return 0;
+    }
+
+  if (!optik_trylock_version(&set->lock, pred_ver))
+    {
+      goto restart;
+    }
+
+  sval_t result = 0;
+  if (found)
+    {
+      result = curr->val;
+      if (expected == 0 || result == expected)
+	{
+	  curr->val = val;
+	}
+    }
+  else
+    {
+      node_l_t* newnode = new_node_l(key, val, curr, 0);
+#ifdef __tile__
+      MEM_BARRIER;
+#endif
+      if (pred != NULL)
+	{
+	  pred->next = newnode;
+	}
+      else
+	{
+	  set->head = newnode;
+	}
+    }
+
+  optik_unlock(&set->lock);
+
+  return result;
+}
+#else  /* LL_GLOBAL_LOCK == 1 :: pessimistic */
+static inline sval_t
+optik_update(intset_l_t *set, skey_t key, sval_t val, sval_t expected, int insert)
+{
+  volatile node_l_t *curr, *pred;
+  COMPILER_NO_REORDER(optik_t pred_ver = set->lock);
+  int found = 0;
+
+  int r;
+  for (r = 0; r < 2; r++)
+    {
+      PARSE_TRY();
+
+      pred = NULL;
+      curr = set->head;
+
+      while (curr != NULL && curr->key < key)
+	{
+	  pred = curr;
+	  curr = curr->next;
+	}
+
+      UPDATE_TRY();
+
+      found = (curr != NULL && curr->key == key);
+      if (!found && !insert)
+	{
+	  if (r)
+	    {
+	      optik_unlock(&set->lock);
+	    }
+	  return 0;
+	}
+
+      if (!r && optik_lock_version(&set->lock, pred_ver))
+	{
+	  break;
+	}
+    }
+
+  sval_t result = 0;
+  if (found)
+    {
+      result = curr->val;
+      if (expected == 0 || result == expected)
+	{
+	  curr->val = val;
+	}
+    }
+  else
+    {
+      node_l_t* newnode = new_node_l(key, val, curr, 0);
+#ifdef __tile__
+      MEM_BARRIER;
+#endif
+      if (pred != NULL)
+	{
+	  pred->next = newnode;
+	}
+      else
+	{
+	  set->head = newnode;
+	}
+    }
+
+  optik_unlock(&set->lock);
+
+  return result;
+}
+#endif	/* LL_GLOBAL_LOCK */
+
+sval_t
+optik_put(intset_l_t *set, skey_t key, sval_t val)
+{
+  return optik_update(set, key, val, 0, 1);
+}
+
+sval_t
+optik_replace(intset_l_t *set, skey_t key, sval_t val)
+{
+  return optik_update(set, key, val, 0, 0);
+}
+
+int
+optik_cas_value(intset_l_t *set, skey_t key, sval_t expected, sval_t val)
+{
+  return (expected != 0 && optik_update(set, key, val, expected, 0) == expected);
+}
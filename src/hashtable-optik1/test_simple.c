@@ -48,19 +48,23 @@
 #endif
 
 #include "hashtable-lock.h"
+#include "in_place.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
  * ################################################################### */
 
 #define DS_CONTAINS(s,k,t)  ht_contains(s, k)
-#define DS_ADD(s,k,t)       ht_add(s, k, k)
+/* with -U, inserts rotate over put, replace, and cas_value (see in_place.h) */
+#define DS_ADD(s,k,t)       (in_place ? IN_PLACE_ADD(s, k, ht_put, ht_replace, ht_cas_value, ht_contains) \
+                             : ht_add(s, k, k))
 #define DS_REMOVE(s,k,t)    ht_remove(s, k)
 #define DS_SIZE(s)          ht_size(s)
 #define DS_NEW()            ht_new()
 
 #define DS_TYPE             ht_intset_t
 #define DS_NODE             node_l_t
+#define DS_MEMORY(s)        ht_memory(s)
 
 /* ################################################################### *
  * GLOBALS
@@ -74,13 +78,18 @@ size_t load_factor = DEFAULT_LOAD;
 size_t update = DEFAULT_UPDATE;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+int in_place = 0;
+IN_PLACE_VARS_DEFINITION();
 
 size_t print_vals_num = 100; 
 size_t pf_vals_num = 1023;
 size_t put, put_explicit = false;
 double update_rate, put_rate, get_rate;
+size_t move = 0, num_tables = 1;
+double move_rate;
 
 size_t size_after = 0;
+size_t memory_after = 0;
 int seed = 0;
 __thread unsigned long * seeds;
 uint32_t rand_max;
@@ -102,6 +111,9 @@ volatile ticks *getting_count_succ;
 volatile ticks *removing_count;
 volatile ticks *removing_count_succ;
 volatile ticks *total;
+volatile ticks *moving_count;
+volatile ticks *moving_count_succ;
+volatile ticks *moving_aborts;
 
 
 /* ################################################################### *
@@ -120,6 +132,7 @@ typedef struct thread_data
 {
   uint32_t id;
   DS_TYPE* set;
+  DS_TYPE* set2;		/* == set if a single table is used */
 } thread_data_t;
 
 void*
@@ -131,6 +144,7 @@ test(void* thread)
   ssalloc_init();
 
   DS_TYPE* set = td->set;
+  DS_TYPE* tables[2] = { td->set, td->set2 };
 
   THREAD_INIT(ID);
   PF_INIT(3, SSPFD_NUM_ENTRIES, ID);
@@ -150,6 +164,9 @@ test(void* thread)
   uint64_t my_putting_count_succ = 0;
   uint64_t my_getting_count_succ = 0;
   uint64_t my_removing_count_succ = 0;
+  uint64_t my_moving_count = 0;
+  uint64_t my_moving_count_succ = 0;
+  uint64_t my_ops = 0;
     
 #if defined(COMPUTE_LATENCY) && PFD_TYPE == 0
   volatile ticks start_acq, end_acq;
@@ -161,6 +178,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
 
   RR_INIT(phys_id);
@@ -170,6 +188,7 @@ test(void* thread)
   int c = 0;
   uint32_t scale_rem = (uint32_t) (update_rate * UINT_MAX);
   uint32_t scale_put = (uint32_t) (put_rate * UINT_MAX);
+  uint32_t scale_move = (uint32_t) (move_rate * UINT_MAX);
 
   int i;
   uint32_t num_elems_thread = (uint32_t) (initial / num_threads);
@@ -183,41 +202,78 @@ test(void* thread)
   num_elems_thread = (ID == 0) * initial;
 #endif
     
-  for(i = 0; i < num_elems_thread; i++) 
+  /* with -t 2, every table gets the initial fill */
+  size_t tb;
+  for (tb = 0; tb < num_tables; tb++)
     {
-      key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
-      if(DS_ADD(set, key, NULL) == false)
+      for(i = 0; i < num_elems_thread; i++) 
 	{
-	  i--;
+	  key = (my_random(&(seeds[0]), &(seeds[1]), &(seeds[2])) % (rand_max + 1)) + rand_min;
+	  if(DS_ADD(tables[tb], key, NULL) == false)
+	    {
+	      i--;
+	    }
 	}
     }
+  in_place_start();
   MEM_BARRIER;
 
   barrier_cross(&barrier);
 
   if (!ID)
     {
-      printf("#BEFORE size is: %zu\n", (size_t) DS_SIZE(set));
+      size_t size_before = DS_SIZE(tables[0]);
+      if (tables[1] != tables[0])
+	{
+	  size_before += DS_SIZE(tables[1]);
+	}
+      printf("#BEFORE size is: %zu\n", size_before);
     }
 
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
   while (stop == 0) 
     {
+      if (unlikely(scale_move != 0))
+	{
+	  c = (uint32_t)(my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])));
+	  if (c < scale_move)
+	    {
+	      key = (c & rand_max) + rand_min;
+	      skey_t key_to = (my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])) & rand_max) + rand_min;
+	      DS_TYPE* from = tables[(my_ops >> 1) & 1];
+	      DS_TYPE* to = tables[my_ops & 1];
+	      my_ops++;
+	      my_moving_count_succ += ht_move(from, key, to, key_to);
+	      my_moving_count++;
+	      continue;
+	    }
+	}
+
+      set = tables[my_ops++ & 1];
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
 
   if (!ID)
     {
-      size_after = DS_SIZE(set);
+      size_after = DS_SIZE(tables[0]);
+      if (tables[1] != tables[0])
+	{
+	  size_after += DS_SIZE(tables[1]);
+	}
+      memory_after = DS_MEMORY(tables[0]) + ((tables[1] != tables[0]) ? DS_MEMORY(tables[1]) : 0);
       printf("#AFTER  size is: %zu\n", size_after);
     }
 
@@ -238,6 +294,10 @@ test(void* thread)
   putting_count_succ[ID] += my_putting_count_succ;
   getting_count_succ[ID] += my_getting_count_succ;
   removing_count_succ[ID]+= my_removing_count_succ;
+  moving_count[ID] += my_moving_count;
+  moving_count_succ[ID] += my_moving_count_succ;
+  moving_aborts[ID] += ht_move_aborts;
+  in_place_publish();
 
   EXEC_IN_DEC_ID_ORDER(ID, num_threads)
     {
@@ -247,7 +307,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -274,6 +336,10 @@ main(int argc, char **argv)
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
     {"load-factor",               required_argument, NULL, 'l'},
+    {"move-rate",                 required_argument, NULL, 'm'},
+    {"tables",                    required_argument, NULL, 't'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {"in-place",                  no_argument,       NULL, 'U'},
     {NULL, 0, NULL, 0}
   };
 
@@ -281,7 +347,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:t:S:U", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -322,6 +388,14 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -m, --move-rate <int>\n"
+		 "        Percentage of atomic ht_move operations (key moves between tables)\n"
+		 "  -t, --tables <int>\n"
+		 "        Number of tables (1 or 2) the threads alternate between (each gets the initial fill)\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 "  -U, --in-place\n"
+		 "        Inserts rotate over put, replace, and cas_value (in-place updates of present keys)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -343,6 +417,12 @@ main(int argc, char **argv)
 	  put_explicit = 1;
 	  put = atoi(optarg);
 	  break;
+	case 'm':
+	  move = atoi(optarg);
+	  break;
+	case 't':
+	  num_tables = atoi(optarg);
+	  break;
 	case 'l':
 	  load_factor = atoi(optarg);
 	  break;
@@ -352,6 +432,12 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case 'U':
+	  in_place = 1;
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -404,6 +490,11 @@ main(int argc, char **argv)
     }
 
   get_rate = 1 - update_rate;
+  move_rate = move / 100.0;
+  if (num_tables < 1 || num_tables > 2)
+    {
+      num_tables = (num_tables < 1) ? 1 : 2;
+    }
 
   /* printf("num_threads = %u\n", num_threads); */
   /* printf("cap: = %u\n", num_buckets); */
@@ -425,6 +516,12 @@ main(int argc, char **argv)
 
   DS_TYPE* set = DS_NEW();
   assert(set != NULL);
+  DS_TYPE* set2 = set;
+  if (num_tables > 1)
+    {
+      set2 = DS_NEW();
+      assert(set2 != NULL);
+    }
 
   /* Initializes the local data */
   putting_succ = (ticks *) calloc(num_threads , sizeof(ticks));
@@ -439,6 +536,9 @@ main(int argc, char **argv)
   getting_count_succ = (ticks *) calloc(num_threads , sizeof(ticks));
   removing_count = (ticks *) calloc(num_threads , sizeof(ticks));
   removing_count_succ = (ticks *) calloc(num_threads , sizeof(ticks));
+  moving_count = (ticks *) calloc(num_threads , sizeof(ticks));
+  moving_count_succ = (ticks *) calloc(num_threads , sizeof(ticks));
+  moving_aborts = (ticks *) calloc(num_threads , sizeof(ticks));
     
   pthread_t threads[num_threads];
   pthread_attr_t attr;
@@ -459,6 +559,7 @@ main(int argc, char **argv)
     {
       tds[t].id = t;
       tds[t].set = set;
+      tds[t].set2 = set2;
       rc = pthread_create(&threads[t], &attr, test, tds + t);
       if (rc)
 	{
@@ -506,6 +607,9 @@ main(int argc, char **argv)
   volatile uint64_t getting_count_total_succ = 0;
   volatile uint64_t removing_count_total = 0;
   volatile uint64_t removing_count_total_succ = 0;
+  volatile uint64_t moving_count_total = 0;
+  volatile uint64_t moving_count_total_succ = 0;
+  volatile uint64_t moving_aborts_total = 0;
     
   for(t=0; t < num_threads; t++) 
     {
@@ -522,6 +626,9 @@ main(int argc, char **argv)
       getting_count_total_succ += getting_count_succ[t];
       removing_count_total += removing_count[t];
       removing_count_total_succ += removing_count_succ[t];
+      moving_count_total += moving_count[t];
+      moving_count_total_succ += moving_count_succ[t];
+      moving_aborts_total += moving_aborts[t];
     }
 
 #if defined(COMPUTE_LATENCY)
@@ -538,10 +645,11 @@ main(int argc, char **argv)
 #define LLU long long unsigned int
 
   int UNUSED pr = (int) (putting_count_total_succ - removing_count_total_succ);
-  if (size_after != (initial + pr))
+  size_t initial_total = initial * num_tables;
+  if (size_after != (initial_total + pr))
     {
-      printf("// WRONG size. %zu + %d != %zu\n", initial, pr, size_after);
-      assert(size_after == (initial + pr));
+      printf("// WRONG size. %zu + %d != %zu\n", initial_total, pr, size_after);
+      assert(size_after == (initial_total + pr));
     }
 
   printf("    : %-10s | %-10s | %-11s | %-11s | %s\n", "total", "success", "succ %", "total %", "effective %");
@@ -558,10 +666,22 @@ main(int argc, char **argv)
 	 (LLU) putting_count_total_succ, putting_perc_succ, putting_perc, (putting_perc * putting_perc_succ) / 100);
   printf("rems: %-10llu | %-10llu | %10.1f%% | %10.1f%% | %10.1f%%\n", (LLU) removing_count_total, 
 	 (LLU) removing_count_total_succ, removing_perc_succ, removing_perc, (removing_perc * removing_perc_succ) / 100);
+  if (in_place)
+    {
+      in_place_print();
+    }
+  if (moving_count_total)
+    {
+      printf("move: %-10llu | %-10llu | %10.1f%% | aborts %llu (%.3f per move)\n", (LLU) moving_count_total,
+	     (LLU) moving_count_total_succ, 100.0 * moving_count_total_succ / moving_count_total,
+	     (LLU) moving_aborts_total, (double) moving_aborts_total / moving_count_total);
+    }
 
-  double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
+  double throughput = (putting_count_total + getting_count_total + removing_count_total + moving_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total + moving_count_total);
+  MEM_STATS_PRINT(memory_after, size_after, sizeof(DS_NODE));
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();    
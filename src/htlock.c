@@ -74,7 +74,7 @@ create_htlock()
 
 
   uint32_t s;
-  for (s = 0; s < NUMBER_OF_SOCKETS; s++)
+  for (s = 0; s < NUMBER_OF_LOCK_SOCKETS; s++)
     {
 #if defined(__x86_64__) && defined(PLATFORM_NUMA)
       numa_set_preferred(s);
@@ -92,7 +92,7 @@ create_htlock()
   htl->global->cur = 0;
   htl->global->nxt = 0;
   uint32_t n;
-  for (n = 0; n < NUMBER_OF_SOCKETS; n++)
+  for (n = 0; n < NUMBER_OF_LOCK_SOCKETS; n++)
     {
       htl->local[n]->cur = NB_TICKETS_LOCAL;
       htl->local[n]->nxt = 0;
@@ -109,7 +109,7 @@ init_htlock(htlock_t* htl)
   htl->global->cur = 0;
   htl->global->nxt = 0;
   uint32_t n;
-  for (n = 0; n < NUMBER_OF_SOCKETS; n++)
+  for (n = 0; n < NUMBER_OF_LOCK_SOCKETS; n++)
     {
       htl->local[n]->cur = NB_TICKETS_LOCAL;
       htl->local[n]->nxt = 0;
@@ -137,7 +137,7 @@ init_alloc_htlock(htlock_t* htl)
 
 
   uint32_t s;
-  for (s = 0; s < NUMBER_OF_SOCKETS; s++)
+  for (s = 0; s < NUMBER_OF_LOCK_SOCKETS; s++)
     {
 #if defined(__x86_64__) && defined(PLATFORM_NUMA)
       numa_set_preferred(s);
@@ -155,7 +155,7 @@ init_alloc_htlock(htlock_t* htl)
   htl->global->cur = 0;
   htl->global->nxt = 0;
   uint32_t n;
-  for (n = 0; n < NUMBER_OF_SOCKETS; n++)
+  for (n = 0; n < NUMBER_OF_LOCK_SOCKETS; n++)
     {
       htl->local[n]->cur = NB_TICKETS_LOCAL;
       htl->local[n]->nxt = 0;
@@ -186,7 +186,14 @@ init_thread_htlocks(uint32_t phys_core)
   my_node = get_cluster(phys_core);
 #else
   my_id = phys_core;
-  my_node = get_cluster(phys_core);
+  if (use_topology())
+    {
+      my_node = get_cpu_socket(topo_thread_cpu(phys_core)) % NUMBER_OF_LOCK_SOCKETS;
+    }
+  else
+    {
+      my_node = get_cluster(phys_core);
+    }
 #endif
   /* printf("id %3d / phys_core %3d / node %d \n", my_id, phys_core, my_node); */
 }
@@ -206,7 +213,7 @@ is_free_hticket(htlock_t* htl)
 }
 
 static htlock_t* 
-create_htlock_no_alloc(htlock_t* htl, htlock_local_t* locals[NUMBER_OF_SOCKETS], size_t offset)
+create_htlock_no_alloc(htlock_t* htl, htlock_local_t* locals[NUMBER_OF_LOCK_SOCKETS], size_t offset)
 {
 #ifdef __sparc__
   htl->global = memalign(CACHE_LINE_SIZE, sizeof(htlock_global_t));
@@ -224,7 +231,7 @@ create_htlock_no_alloc(htlock_t* htl, htlock_local_t* locals[NUMBER_OF_SOCKETS],
 
 
   uint32_t s;
-  for (s = 0; s < NUMBER_OF_SOCKETS; s++)
+  for (s = 0; s < NUMBER_OF_LOCK_SOCKETS; s++)
     {
       htl->local[s] = locals[s] + offset;
     }
@@ -233,7 +240,7 @@ create_htlock_no_alloc(htlock_t* htl, htlock_local_t* locals[NUMBER_OF_SOCKETS],
   htl->global->cur = 0;
   htl->global->nxt = 0;
   uint32_t n;
-  for (n = 0; n < NUMBER_OF_SOCKETS; n++)
+  for (n = 0; n < NUMBER_OF_LOCK_SOCKETS; n++)
     {
       htl->local[n]->cur = NB_TICKETS_LOCAL;
       htl->local[n]->nxt = 0;
@@ -262,9 +269,9 @@ init_htlocks(uint32_t num_locks)
 
   size_t alloc_locks = (num_locks < 64) ? 64 : num_locks;
 
-  htlock_local_t* locals[NUMBER_OF_SOCKETS];
+  htlock_local_t* locals[NUMBER_OF_LOCK_SOCKETS];
   uint32_t n;
-  for (n = 0; n < NUMBER_OF_SOCKETS; n++)
+  for (n = 0; n < NUMBER_OF_LOCK_SOCKETS; n++)
     {
 #if defined(__x86_64__) && defined(PLATFORM_NUMA)
       numa_set_preferred(n);
@@ -84,6 +84,7 @@ copy_on_write_new_init()
   INIT_LOCK_A(cow->lock);
 
   cow->array = array_ll_new_init(0);
+  cow->pending = NULL;
   return cow;
 }
 
@@ -94,110 +95,210 @@ copy_on_write_new()
 }
 
 
+/* index of the first element with a key >= key (branch-free binary search) */
+static inline size_t
+cpy_array_lower_bound(array_ll_t* all, skey_t key)
+{
+  size_t n = all->size;
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  volatile kv_t* base = all->kvs;
+  while (n > 1)
+    {
+      size_t half = n >> 1;
+      base = (base[half].key < key) ? base + half : base;
+      n -= half;
+    }
+  return (base - all->kvs) + (base->key < key);
+}
+
 sval_t
 cpy_search(copy_on_write_t* set, skey_t key) 
 {
   array_ll_t* all_cur = (array_ll_t*) set->array;
 
-  int i;
-  for (i = 0; i < all_cur->size; i++)
+  size_t i = cpy_array_lower_bound(all_cur, key);
+  if (i < all_cur->size && all_cur->kvs[i].key == key)
     {
-      if (unlikely(all_cur->kvs[i].key == key))
-	{
-	  return all_cur->kvs[i].val;
-	}
+      return all_cur->kvs[i].val;
     }
 
   return 0;
 }
 
-sval_t
-cpy_delete(copy_on_write_t* set, skey_t key)
+/*
+ * applies the n requests (in key order; for the same key in the order given)
+ * with a single copy of the array. Must hold the lock.
+ */
+static void
+cpy_apply(copy_on_write_t* set, cpy_req_t** reqs, int n)
 {
-#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
-  if (cpy_search(set, key) == 0)
+  int r, q;
+  for (r = 1; r < n; r++)
     {
-      return 0;
+      cpy_req_t* req = reqs[r];
+      for (q = r; q > 0 && reqs[q - 1]->key > req->key; q--)
+	{
+	  reqs[q] = reqs[q - 1];
+	}
+      reqs[q] = req;
     }
-#endif
-
-  sval_t removed = 0;
-
-  LOCK_A(set->lock);
 
   volatile array_ll_t* all_old = set->array;
-  array_ll_t* all_new = array_ll_new(all_old->size - 1);
+  array_ll_t* all_new = array_ll_new(0);
 
-  int i, n;
-  for (i = 0, n = 0; i < all_old->size; i++, n++)
+  size_t o = 0, m = 0;
+  int changed = 0;
+  for (r = 0; r < n;)
     {
-      if (unlikely(all_old->kvs[i].key == key))
+      skey_t key = reqs[r]->key;
+      for (; o < all_old->size && all_old->kvs[o].key < key; o++, m++)
+	{
+	  all_new->kvs[m].key = all_old->kvs[o].key;
+	  all_new->kvs[m].val = all_old->kvs[o].val;
+	}
+
+      int present = 0;
+      sval_t val = 0;
+      if (o < all_old->size && all_old->kvs[o].key == key)
 	{
-	  removed = all_old->kvs[i].val;
-	  n--;
-	  continue;
+	  present = 1;
+	  val = all_old->kvs[o++].val;
 	}
 
-      all_new->kvs[n].key = all_old->kvs[i].key;
-      all_new->kvs[n].val = all_old->kvs[i].val;
+      for (; r < n && reqs[r]->key == key; r++)
+	{
+	  cpy_req_t* req = reqs[r];
+	  if (req->insert)
+	    {
+	      req->result = !present;
+	      if (!present)
+		{
+		  present = changed = 1;
+		  val = req->val;
+		}
+	    }
+	  else
+	    {
+	      req->result = present ? val : 0;
+	      if (present)
+		{
+		  present = 0;
+		  changed = 1;
+		}
+	    }
+	}
+
+      if (present)
+	{
+	  all_new->kvs[m].key = key;
+	  all_new->kvs[m].val = val;
+	  m++;
+	}
     }
 
+  for (; o < all_old->size; o++, m++)
+    {
+      all_new->kvs[m].key = all_old->kvs[o].key;
+      all_new->kvs[m].val = all_old->kvs[o].val;
+    }
+  all_new->size = m;
+
 #ifdef __tile__
   MEM_BARRIER;
 #endif
 
   void* to_delete = (void*) all_new;
-  if (removed)
+  if (changed)
     {
       set->array = all_new;
       to_delete = (void*) all_old;
     }
-
-  UNLOCK_A(set->lock);
   cpy_delete_copy(alloc, (void*) to_delete);
-  return removed;
+
+  for (r = 0; r < n; r++)
+    {
+      reqs[r]->done = 1;	/* the request (on the stack of its owner) is now gone */
+    }
 }
 
-int
-cpy_insert(copy_on_write_t* set, skey_t key, sval_t val) 
+#if CPY_ON_WRITE_BATCH == 1
+/* applies all the pending requests. Must hold the lock. */
+static void
+cpy_combine(copy_on_write_t* set)
 {
+  cpy_req_t* reqs[CPY_ON_WRITE_BATCH_MAX];
+  cpy_req_t* list = SWAP_PTR(&set->pending, NULL);
+  while (list != NULL)
+    {
+      int n = 0;
+      while (list != NULL && n < CPY_ON_WRITE_BATCH_MAX)
+	{
+	  reqs[n++] = list;
+	  list = list->next;
+	}
+      cpy_apply(set, reqs, n);
+    }
+}
+#endif
 
+static sval_t
+cpy_update(copy_on_write_t* set, cpy_req_t* req)
+{
+#if CPY_ON_WRITE_BATCH == 1
+  req->done = 0;
+  cpy_req_t* head;
+  do
+    {
+      head = set->pending;
+      req->next = head;
+    }
+  while (CAS_PTR(&set->pending, head, req) != head);
+
+  LOCK_A(set->lock);
+  /* if not done, the request is still pending: no combiner released the lock since */
+  if (!req->done)
+    {
+      cpy_combine(set);
+    }
+  UNLOCK_A(set->lock);
+#else
+  LOCK_A(set->lock);
+  cpy_apply(set, &req, 1);
+  UNLOCK_A(set->lock);
+#endif
+  return req->result;
+}
+
+sval_t
+cpy_delete(copy_on_write_t* set, skey_t key)
+{
 #if CPY_ON_WRITE_READ_ONLY_FAIL == 1
-  if (cpy_search(set, key) != 0)
+  if (cpy_search(set, key) == 0)
     {
       return 0;
     }
 #endif
 
-  LOCK_A(set->lock);
-
-  volatile array_ll_t* all_old = set->array;
-  array_ll_t* all_new = array_ll_new(all_old->size + 1);
+  cpy_req_t req = { .key = key, .val = 0, .insert = 0 };
+  return cpy_update(set, &req);
+}
 
-  int i;
-  for (i = 0; i < all_old->size; i++)
+int
+cpy_insert(copy_on_write_t* set, skey_t key, sval_t val) 
+{
+#if CPY_ON_WRITE_READ_ONLY_FAIL == 1
+  if (cpy_search(set, key) != 0)
     {
-      if (unlikely(all_old->kvs[i].key == key))
-	{
-	  UNLOCK_A(set->lock);
-	  cpy_delete_copy(alloc, all_new);
-	  return 0;
-	}
-      all_new->kvs[i].key = all_old->kvs[i].key;
-      all_new->kvs[i].val = all_old->kvs[i].val;
+      return 0;
     }
-
-  all_new->kvs[i].key = key;
-  all_new->kvs[i].val = val;
-  
-#ifdef __tile__
-  MEM_BARRIER;
 #endif
 
-  set->array = all_new;
-  UNLOCK_A(set->lock);
-  cpy_delete_copy(alloc, (void*) all_old);
-  return 1;
+  cpy_req_t req = { .key = key, .val = val, .insert = 1 };
+  return cpy_update(set, &req);
 }
 
 size_t
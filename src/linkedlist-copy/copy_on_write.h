@@ -50,6 +50,18 @@
 #define CPY_ON_WRITE_READ_ONLY_FAIL     RO_FAIL
 #define CPY_ON_WRITE_USE_MEM_RELEAS     1
 
+/*
+ * The arrays are kept sorted by key (binary search in cpy_search). With
+ * BATCH=1 (CPY_ON_WRITE_BATCH), an update is published in a list of pending
+ * requests before taking the lock; the thread that gets the lock applies all
+ * the pending requests with a single copy of the array, so that concurrent
+ * writers do not each copy the whole array.
+ */
+#if !defined(CPY_ON_WRITE_BATCH)
+#  define CPY_ON_WRITE_BATCH            0
+#endif
+#define CPY_ON_WRITE_BATCH_MAX          64
+
 static volatile int stop;
 extern __thread ssmem_allocator_t* alloc;
 
@@ -67,6 +79,16 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct array_ll
 } array_ll_t;
 
 
+typedef struct cpy_req
+{
+  struct cpy_req* next;
+  skey_t key;
+  sval_t val;
+  sval_t result;
+  uint8_t insert;
+  volatile uint8_t done;
+} cpy_req_t;
+
 typedef ALIGNED(CACHE_LINE_SIZE) struct copy_on_write
 {
    union
@@ -75,6 +97,7 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct copy_on_write
      {
        volatile ptlock_t* lock;
        volatile array_ll_t* array;
+       cpy_req_t* volatile pending;
      };
      uint8_t padding[CACHE_LINE_SIZE];
    };
@@ -79,6 +79,56 @@ get_marked_ref(long w)
  * Encountered nodes that are marked as logically deleted are physically removed
  * from the list, yet not garbage collected.
  */
+#if GC == 3
+/*
+ * With hazard pointers, the search cannot skip a chain of marked nodes and
+ * unlink it with a single CAS, because it reads the nodes of the chain
+ * without protecting them. Instead, it protects every right_node, validates
+ * that left_node->next still points to it, and unlinks the marked nodes one
+ * at a time (as in the list of Michael).
+ */
+node_t*
+harris_search(intset_t *set, skey_t key, node_t **left_node) 
+{
+  node_t *left, *right, *right_next;
+ retry:
+  PARSE_TRY();
+  left = set->head;
+  right = set->head->next;
+  while (1)
+    {
+      hzd_protect(HZD_RIGHT, (void*) right);
+      if (unlikely(left->next != right))
+	{
+	  goto retry;
+	}
+
+      right_next = right->next;
+      if (is_marked_ref((long) right_next))
+	{
+	  CLEANUP_TRY();
+	  right_next = (node_t*) get_unmarked_ref((long) right_next);
+	  if (!ATOMIC_CAS_MB(&left->next, right, right_next))
+	    {
+	      goto retry;
+	    }
+	  hzd_retire((void*) right);
+	}
+      else
+	{
+	  if (right->key >= key)
+	    {
+	      break;
+	    }
+	  left = right;
+	  hzd_copy(HZD_LEFT, (void*) left);
+	}
+      right = right_next;
+    }
+  *left_node = left;
+  return right;
+}
+#else
 node_t*
 harris_search(intset_t *set, skey_t key, node_t **left_node) 
 {
@@ -145,6 +195,7 @@ harris_search(intset_t *set, skey_t key, node_t **left_node)
     } 
   while (1);
 }
+#endif	/* GC == 3 */
 
 /*
  * harris_find returns whether there is a node in the list owning value val.
@@ -187,6 +238,11 @@ harris_insert(intset_t *set, skey_t key, sval_t val)
 	    {
 	      ssmem_free(alloc, (void*) newnode);
 	    }
+#elif GC == 3
+	  if (unlikely(newnode != NULL))
+	    {
+	      hzd_free((void*) newnode);
+	    }
 #endif
 	  return 0;
 	}
@@ -244,6 +300,8 @@ harris_delete(intset_t *set, skey_t key)
     {
 #if GC == 1
       ssmem_free(alloc, (void*) get_unmarked_ref((long) right_node));
+#elif GC == 3
+      hzd_retire((void*) right_node);
 #endif
       ;
     }
@@ -39,7 +39,15 @@ new_node(skey_t key, sval_t val, node_t* next, int initializing)
     {
       node = (volatile node_t *) ssmem_alloc(alloc, sizeof(node_t));
     }
-
+#elif GC == 3
+  if (unlikely(initializing))
+    {
+      node = (volatile node_t *) ssalloc(sizeof(node_t));
+    }
+  else
+    {
+      node = (volatile node_t *) hzd_alloc();
+    }
 #else
   node = (volatile node_t *) ssalloc(sizeof(node_t));
 #endif
@@ -62,6 +62,11 @@ physical_delete_right(node_t* left_node, node_t* right_node)
     {
       ssmem_free(alloc, (void*) res);
     }
+#elif GC == 3
+  if (likely(removed))
+    {
+      hzd_retire((void*) res);
+    }
 #endif
   return removed;
 }
@@ -74,15 +79,28 @@ physical_delete_right(node_t* left_node, node_t* right_node)
  *  - sets the left_node to the node owning the value immediately lower than val. 
  * Encountered nodes that are marked as logically deleted are physically removed
  * from the list, yet not garbage collected.
+ * With hazard pointers (GC == 3), the search protects right_node and then
+ * validates that left_node->next still points to it (as in the list of
+ * Michael), so that it never reads a node that might have been reclaimed.
  */
 static inline node_t* 
 list_search(intset_t* set, skey_t key, node_t** left_node_ptr) 
 {
+#if GC == 3
+ retry:
+#endif
   PARSE_TRY();
   node_t* left_node = set->head;
   node_t* right_node = set->head->next;
   while(1)
     {
+#if GC == 3
+      hzd_protect(HZD_RIGHT, (void*) right_node);
+      if (unlikely(left_node->next != right_node))
+	{
+	  goto retry;
+	}
+#endif
       if (likely(!is_marked_ref(right_node->next)))
 	{
 	  if (unlikely(right_node->key >= key))
@@ -90,6 +108,9 @@ list_search(intset_t* set, skey_t key, node_t** left_node_ptr)
 	      break;
 	    }
 	  left_node = right_node;
+#if GC == 3
+	  hzd_copy(HZD_LEFT, (void*) left_node);
+#endif
 	}
       else 
 	{
@@ -108,6 +129,11 @@ list_search(intset_t* set, skey_t key, node_t** left_node_ptr)
 sval_t
 harris_find(intset_t* the_list, skey_t key)
 {
+#if GC == 3
+  /* the wait-free traversal would go through nodes that are not protected */
+  node_t* l;
+  node_t* node = list_search(the_list, key, &l);
+#else
   node_t* node = the_list->head->next;
   PARSE_TRY();
   while(likely(node->key < key))
@@ -116,6 +142,7 @@ harris_find(intset_t* the_list, skey_t key)
     }
   /* node_t* l; */
   /* node_t* node = list_search(the_list, key, &l); */
+#endif
 
   if (node->key == key && !is_marked_ref(node->next)) 
     {
@@ -156,6 +183,8 @@ harris_insert(intset_t *the_list, skey_t key, sval_t val)
 
 #if GC == 1
       ssmem_free(alloc, (void*) node_to_add);
+#elif GC == 3
+      hzd_free((void*) node_to_add);
 #endif
     } 
   while (1);
@@ -46,6 +46,9 @@ set_contains(intset_t *set, skey_t key)
   result = (next->key == key) ? next->val : 0;
 #elif defined LOCKFREE			
   result = harris_find(set, key);
+#  if GC == 3
+  hzd_clear();
+#  endif
 #endif	
 	
   return result;
@@ -85,6 +88,9 @@ set_add(intset_t *set, skey_t key, skey_t val)
   result = set_seq_add(set, key, val);
 #elif defined LOCKFREE
   result = harris_insert(set, key, val);
+#  if GC == 3
+  hzd_clear();
+#  endif
 #endif
   return result;
 }
@@ -116,6 +122,9 @@ set_remove(intset_t *set, skey_t key)
     }
 #elif defined LOCKFREE
   result = harris_delete(set, key);
+#  if GC == 3
+  hzd_clear();
+#  endif
 #endif
 	
   return result;
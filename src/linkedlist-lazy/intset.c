@@ -33,11 +33,15 @@ set_contains_l(intset_l_t* set, skey_t key)
 int
 set_add_l(intset_l_t* set, skey_t key, sval_t val)
 {  
-      return parse_insert(set, key, val);
+      int ret = parse_insert(set, key, val);
+      SIZE_COUNTER_INC(set->sizes, ret);
+      return ret;
 }
 
 sval_t
 set_remove_l(intset_l_t* set, skey_t key)
 {
-      return parse_delete(set, key);
+      sval_t ret = parse_delete(set, key);
+      SIZE_COUNTER_DEC(set->sizes, ret != 0);
+      return ret;
 }
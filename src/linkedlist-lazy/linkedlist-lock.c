@@ -80,6 +80,7 @@ intset_l_t *set_new_l()
   /* ssalloc_align_alloc(0); */
   min = new_node_l(KEY_MIN, 0, max, 1);
   set->head = min;
+  set->sizes = SIZE_COUNTER_NEW();
 
 #if defined(LL_GLOBAL_LOCK)
   set->lock = (volatile ptlock_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(ptlock_t));
@@ -117,6 +118,7 @@ void set_delete_l(intset_l_t *set)
       ssfree((void*) node);		/* TODO : fix with ssmem */
       node = next;
     }
+  SIZE_COUNTER_FREE(set->sizes);
   ssfree(set);
 }
 
@@ -136,6 +138,17 @@ int set_size_l(intset_l_t *set)
   return size;
 }
 
+/* O(threads) with SIZE_COUNTERS (see size_counter.h), a traversal otherwise */
+size_t
+set_size_approx_l(intset_l_t* set)
+{
+#if SIZE_COUNTERS == 1
+  return size_counter_read(set->sizes);
+#else
+  return set_size_l(set);
+#endif
+}
+
 
 
 	
@@ -70,6 +70,7 @@ STATIC_ASSERT(sizeof(node_l_t) == 32, "sizeof(node_l_t) == 32");
 typedef ALIGNED(CACHE_LINE_SIZE) struct intset_l 
 {
   node_l_t* head;
+  size_counter_t* sizes;	/* with SIZE_COUNTERS */
 #if defined(LL_GLOBAL_LOCK)
   /* char padding[56]; */
   volatile ptlock_t* lock;
@@ -80,6 +81,7 @@ node_l_t* new_node_l(skey_t key, sval_t val, node_l_t* next, int initializing);
 intset_l_t* set_new_l();
 void set_delete_l(intset_l_t* set);
 int set_size_l(intset_l_t* set);
+size_t set_size_approx_l(intset_l_t* set);
 void node_delete_l(node_l_t* node);
 
 #endif	/* _H_LINKEDLIST_LOCK_ */
@@ -77,6 +77,11 @@ physical_delete_right(node_t* left_node, node_t* right_node)
     {
       ssmem_free(alloc, (void*) res);
     }
+#elif GC == 3
+  if (removed)
+    {
+      hzd_retire((void*) res);
+    }
 #endif
   return removed;
 }
@@ -88,6 +93,9 @@ physical_delete_right(node_t* left_node, node_t* right_node)
  *  - sets the left_node to the node owning the value immediately lower than val. 
  * Encountered nodes that are marked as logically deleted are physically removed
  * from the list, yet not garbage collected.
+ * With hazard pointers (GC == 3), left_node and right_node are protected when
+ * list_search returns: right_node is published before the check that
+ * left_node->next still points to it.
  */
 static inline node_t* 
 list_search(intset_t* set, skey_t key, node_t** left_node_ptr) 
@@ -101,6 +109,9 @@ list_search(intset_t* set, skey_t key, node_t** left_node_ptr)
   right_node = set->head->next;
   while(1)
     {
+#if GC == 3
+      hzd_protect(HZD_RIGHT, (void*) right_node);
+#endif
       if (unlikely(left_node->next != right_node))
 	{
 	  goto retry;
@@ -121,6 +132,9 @@ list_search(intset_t* set, skey_t key, node_t** left_node_ptr)
 	      break;
 	    }
 	  left_node = right_node;
+#if GC == 3
+	  hzd_copy(HZD_LEFT, (void*) left_node);
+#endif
 	}
       right_node = (node_t*)get_unmarked_ref((long)right_node->next);
     }
@@ -167,6 +181,11 @@ michael_insert(intset_t *the_list, skey_t key, sval_t val)
 	    {
 	      ssmem_free(alloc, (void*) node_to_add);
 	    }
+#elif GC == 3
+	  if (unlikely(node_to_add != NULL))
+	    {
+	      hzd_free((void*) node_to_add);
+	    }
 #endif
 	  return 0;
 	}
@@ -48,14 +48,20 @@
 #endif
 
 #include "intset.h"
+#include "delegation.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
  * ################################################################### */
 
-#define DS_CONTAINS(s,k,t)  set_contains_l(s, k)
-#define DS_ADD(s,k,t)       set_add_l(s, k, k)
-#define DS_REMOVE(s,k,t)    set_remove_l(s, k)
+#define DS_CONTAINS_LOCAL(s,k,t) set_contains_l(s, k)
+#define DS_ADD_LOCAL(s,k,t)      set_add_l(s, k, k)
+#define DS_REMOVE_LOCAL(s,k,t)   set_remove_l(s, k)
+
+/* with -D, the operations are delegated to server threads */
+#define DS_CONTAINS(s,k,t)  DLG(DLG_OP_CONTAINS, k, t, DS_CONTAINS_LOCAL(s, k, t))
+#define DS_ADD(s,k,t)       DLG(DLG_OP_ADD, k, t, DS_ADD_LOCAL(s, k, t))
+#define DS_REMOVE(s,k,t)    DLG(DLG_OP_REMOVE, k, t, DS_REMOVE_LOCAL(s, k, t))
 #define DS_SIZE(s)          set_size_l(s)
 #define DS_NEW(size)        set_new_l(size)
 
@@ -74,6 +80,7 @@ size_t load_factor;
 size_t update = DEFAULT_UPDATE;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+size_t delegates = 0;
 int test_verbose = 0;
 
 size_t print_vals_num = 100; 
@@ -89,6 +96,7 @@ uint32_t rand_max;
 
 static volatile int stop;
 TEST_VARS_GLOBAL;
+DELEGATION_VARS_DEFINITION();
 
 volatile ticks *putting_succ;
 volatile ticks *putting_fail;
@@ -123,6 +131,22 @@ typedef struct thread_data
   DS_TYPE* set;
 } thread_data_t;
 
+/* the operations of the clients, executed by the delegation servers */
+static sval_t
+dlg_exec(void* s, uint32_t op, skey_t key, sval_t val)
+{
+  DS_TYPE* set = (DS_TYPE*) s;
+  switch (op)
+    {
+    case DLG_OP_CONTAINS:
+      return (sval_t) DS_CONTAINS_LOCAL(set, key, val);
+    case DLG_OP_ADD:
+      return (sval_t) DS_ADD_LOCAL(set, key, val);
+    default:
+      return (sval_t) DS_REMOVE_LOCAL(set, key, val);
+    }
+}
+
 void*
 test(void* thread) 
 {
@@ -134,6 +158,7 @@ test(void* thread)
   DS_TYPE* set = td->set;
 
   THREAD_INIT(ID);
+  dlg_client_init(ID);
   PF_INIT(3, SSPFD_NUM_ENTRIES, ID);
 
 #if defined(COMPUTE_LATENCY)
@@ -162,6 +187,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
 
   RR_INIT(phys_id);
@@ -204,7 +230,10 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -212,6 +241,7 @@ test(void* thread)
     {
       TEST_LOOP(NULL);
     }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -248,7 +278,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -275,6 +307,8 @@ main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"stall",                     required_argument, NULL, 'S'},
+    {"delegate",                  required_argument, NULL, 'D'},
     {NULL, 0, NULL, 0}
   };
 
@@ -282,7 +316,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:el:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:el:p:b:v:f:S:D:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -325,6 +359,10 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
+		 "  -D, --delegate <int>\n"
+		 "        Delegation: <int> server threads execute the operations of the -n threads (0: off)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -358,6 +396,12 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
+	case 'D':
+	  delegates = atoi(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -429,6 +473,11 @@ main(int argc, char **argv)
   DS_TYPE* set = DS_NEW(initial);
   assert(set != NULL);
 
+  if (delegates > 0)
+    {
+      dlg_start(num_threads, delegates, set, dlg_exec);
+    }
+
   /* Initializes the local data */
   putting_succ = (ticks *) calloc(num_threads , sizeof(ticks));
   putting_fail = (ticks *) calloc(num_threads , sizeof(ticks));
@@ -493,6 +542,7 @@ main(int argc, char **argv)
     }
 
   free(tds);
+  dlg_stop();
     
   volatile ticks putting_suc_total = 0;
   volatile ticks putting_fal_total = 0;
@@ -568,6 +618,9 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, sizeof(DS_NODE));
+  dlg_print();
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();    
@@ -28,6 +28,19 @@
 #define EXINLINED
 #include "measurements.h"
 #include "latency.h"
+#include "perf_events.h"
+#include "topology.h"
+#include "mem_stats.h"
+#include "huge_pages.h"
+#include "size_counter.h"
+#include "backoff.h"
+
+PE_VARS_DEFINITION();
+TOPO_VARS_DEFINITION();
+MEM_STATS_VARS_DEFINITION();
+HP_VARS_DEFINITION();
+SIZE_COUNTER_VARS_DEFINITION();
+BACKOFF_VARS_DEFINITION();
 
 __thread ticks getticks_correction = 0;
 ticks getticks_correction_calc() 
@@ -25,6 +25,7 @@
 
 int core = 0;
 int direct = 0;
+TOPO_VARS_DEFINITION();
 
 
 typedef struct thd
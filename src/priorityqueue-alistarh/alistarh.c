@@ -45,6 +45,13 @@ extern ALIGNED(CACHE_LINE_SIZE) unsigned int levelmax;
 #define ALISTARH_MAX_JUMP_CONSTANT          1	//J
 #define ALISTARH_LEVELS_TO_DESCEND          1	//D
 
+/* the spray parameters: H = K*log(p), L = J*(log(p)+1), descend D levels per
+   step. The defaults are the constants above; alistarh_set_spray changes them
+   before alistarh_init (larger K and J: more relaxation, less contention) */
+unsigned int height_constant = ALISTARH_STARTING_HEIGHT_CONSTANT;
+unsigned int jump_constant = ALISTARH_MAX_JUMP_CONSTANT;
+unsigned int levels_to_descend = ALISTARH_LEVELS_TO_DESCEND;
+
 unsigned int num_threads; //p
 unsigned int starting_height; //H
 unsigned int max_jump_length; //L
@@ -54,12 +61,24 @@ sl_node_t* last_dummy_entry;
 //KEY_MIN+1 as the value is reserved for dummy entries,
 //while KEY_MIN as the key respresents the head of the skiplist!
 
+void
+alistarh_set_spray(unsigned int height_k, unsigned int jump_j, unsigned int descend_d)
+{
+  height_constant = height_k;
+  jump_constant = jump_j > 0 ? jump_j : 1;
+  levels_to_descend = descend_d > 0 ? descend_d : 1;
+}
+
 void
 alistarh_init(int _num_threads, sl_intset_t* set, int padding)
 {
   num_threads = _num_threads;
-  starting_height = floor_log_2(num_threads);
-  max_jump_length = floor_log_2(num_threads)+1;
+  starting_height = height_constant*floor_log_2(num_threads);
+  if (starting_height >= levelmax)
+    {
+      starting_height = levelmax - 1;
+    }
+  max_jump_length = jump_constant*(floor_log_2(num_threads)+1);
   cleaner_percentage = (99+(num_threads/2))/num_threads;
   cleaner_percentage = cleaner_percentage>1?cleaner_percentage:1;
   
@@ -217,12 +236,31 @@ fraser_remove(sl_intset_t *set, skey_t key)
   return result;
 }
 
+/* random walk from the head: the node the spray lands on (might be the head) */
+static inline sl_node_t*
+alistarh_spray_walk(sl_intset_t *set)
+{
+  sl_node_t *next, *node = set->head;
+  int i, level;
+  for(level = starting_height; level>=0; level-=levels_to_descend)
+  {
+    i = (int)rand_range(max_jump_length);
+    for (; i>0; i--)
+    {
+      next = GET_UNMARKED(node->next[level]);
+      if (next==NULL || next->next[0]==NULL)
+        break;
+      node = next;
+    }
+  }
+  return node;
+}
+
 sval_t
 alistarh_deleteMin(sl_intset_t *set)
 {
   sval_t result;
-  sl_node_t *next, *node;
-  int i, level;
+  sl_node_t *node;
   
  retry:
   if (unlikely(rand_range(100) <= cleaner_percentage))
@@ -253,19 +291,7 @@ alistarh_deleteMin(sl_intset_t *set)
   
     PARSE_START_TS(3);
     result = 0;
-    node = set->head;
-    next = NULL;
-    for(level = starting_height; level>=0; level-=ALISTARH_LEVELS_TO_DESCEND)
-    {
-      i = (int)rand_range(max_jump_length);
-      for (; i>0; i--)
-      {
-        next = GET_UNMARKED(node->next[level]);
-        if (next==NULL || next->next[0]==NULL)
-          break;
-        node = next;
-      }
-    }
+    node = alistarh_spray_walk(set);
     PARSE_END_TS(3, lat_parsing_deleteMin++);
   
     if (unlikely(node == set->head))
@@ -290,6 +316,61 @@ alistarh_deleteMin(sl_intset_t *set)
   }
 }
 
+/*
+ * claims up to k elements with a single traversal: one spray (or, for the
+ * cleaners, the first element after the dummies), then the next k live
+ * nodes at level 0. The marked nodes are unlinked with a single search for
+ * the last claimed key. Returns the number of elements written to out (0
+ * only if the queue is empty).
+ */
+size_t
+alistarh_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out)
+{
+  sl_node_t *node, *last = NULL;
+  size_t n = 0;
+  int cleaner = (rand_range(100) <= cleaner_percentage);
+
+  UPDATE_TRY();
+  PARSE_START_TS(3);
+  node = cleaner ? last_dummy_entry : alistarh_spray_walk(set);
+  PARSE_END_TS(3, lat_parsing_deleteMin++);
+
+  while (1)
+    {
+      if (node == set->head)
+	{
+	  node = GET_UNMARKED(node->next[0]);
+	}
+      for (; node->next[0] != NULL && n < k; node = GET_UNMARKED(node->next[0]))
+	{
+	  if (node->val == KEY_MIN+1 || node->deleted)
+	    {
+	      continue;
+	    }
+	  if (ATOMIC_FETCH_AND_INC_FULL(&node->deleted) == 0)
+	    {
+	      mark_node_ptrs(node);
+	      out[n++] = node->val;
+	      last = node;
+	    }
+	}
+
+      /* the spray landed past the last live element: retry as a cleaner */
+      if (n > 0 || cleaner)
+	{
+	  break;
+	}
+      cleaner = 1;
+      node = last_dummy_entry;
+    }
+
+  if (last != NULL)
+    {
+      fraser_search(set, last->key, NULL, NULL);
+    }
+  return n;
+}
+
 int
 fraser_insert(sl_intset_t *set, skey_t key, sval_t val) 
 {
@@ -373,25 +454,12 @@ fraser_insert(sl_intset_t *set, skey_t key, sval_t val)
 skey_t
 alistarh_spray(sl_intset_t *set)
 {
-  sl_node_t *next, *node;
-  int i, level;
+  sl_node_t *node;
   
  retry:
   UPDATE_TRY();
   PARSE_START_TS(3);
-  node = set->head;
-  next = NULL;
-  for(level = starting_height; level>=0; level-=ALISTARH_LEVELS_TO_DESCEND)
-  {
-    i = (int)rand_range(max_jump_length);
-    for (; i>0; i--)
-    {
-      next = GET_UNMARKED(node->next[level]);
-      if (next==NULL || next->next[0]==NULL)
-        break;
-      node = next;
-    }
-  }
+  node = alistarh_spray_walk(set);
   PARSE_END_TS(3, lat_parsing_deleteMin++);
   if (unlikely(node == set->head))
     goto retry;
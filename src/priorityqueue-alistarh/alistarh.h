@@ -28,6 +28,8 @@ sval_t fraser_find(sl_intset_t *set, skey_t key);
 sval_t fraser_remove(sl_intset_t *set, skey_t key);
 int fraser_insert(sl_intset_t *set, skey_t key, sval_t val);
 
+void alistarh_set_spray(unsigned int height_k, unsigned int jump_j, unsigned int descend_d);
 void alistarh_init(int _num_threads, sl_intset_t* set, int padding);
 sval_t alistarh_deleteMin(sl_intset_t *set);
+size_t alistarh_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out);
 skey_t alistarh_spray(sl_intset_t *set);
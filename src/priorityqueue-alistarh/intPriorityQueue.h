@@ -27,3 +27,5 @@
 sval_t pq_contains(sl_intset_t *set, skey_t key);
 int pq_insert(sl_intset_t *set, skey_t key, sval_t val);
 sval_t pq_deleteMin(sl_intset_t *set);
+size_t pq_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out);
+size_t pq_rank(sl_intset_t *set, skey_t key);
@@ -119,4 +119,42 @@ pq_deleteMin(sl_intset_t *set)
   return result;
 }
 
+/* claims up to k elements in one traversal; returns how many are in out */
+size_t
+pq_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out)
+{
+  size_t n = 0;
+#ifdef SEQUENTIAL
+  for (; n < k; n++)
+    {
+      if ((out[n] = pq_deleteMin(set)) == 0)
+	{
+	  break;
+	}
+    }
+#elif defined LOCKFREE
+  n = prioritySL_deleteMin_batch(set, k, out);
+#endif
+  return n;
+}
 
+/*
+ * the number of live elements smaller than key: the rank error of a
+ * deleteMin that returned key. Only for measurements: it is not
+ * linearizable and walks the list up to key.
+ */
+size_t
+pq_rank(sl_intset_t *set, skey_t key)
+{
+  size_t rank = 0;
+  sl_node_t *node = GET_UNMARKED(set->head->next[0]);
+  while (node->next[0] != NULL && node->key < key)
+    {
+      if (!IS_MARKED(node->next[0]))
+	{
+	  rank++;
+	}
+      node = GET_UNMARKED(node->next[0]);
+    }
+  return rank;
+}
@@ -288,6 +288,37 @@ prioritySL_deleteMin(sl_intset_t *set)
   return result;
 }
 
+/*
+ * claims the (up to) k first live elements with a single traversal of level
+ * 0, then unlinks the marked nodes with a single search for the last one
+ */
+size_t
+prioritySL_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out)
+{
+  size_t n = 0;
+  sl_node_t *node, *last = NULL;
+  PARSE_START_TS(4);
+  node = GET_UNMARKED(set->head->next[0]);
+  while (node->next[0] != NULL && n < k)
+  {
+    if (!IS_MARKED(node->next[node->toplevel-1]))
+    {
+      if (mark_node_ptrs(node))
+      {
+        out[n++] = node->val;
+        last = node;
+      }
+    }
+    node = GET_UNMARKED(node->next[0]);
+  }
+  if (last != NULL)
+  {
+    fraser_search(set, last->key, NULL, NULL);
+  }
+  PARSE_END_TS(4, lat_parsing_cleaner++);
+  return n;
+}
+
 
 int
 fraser_insert(sl_intset_t *set, skey_t key, sval_t val) 
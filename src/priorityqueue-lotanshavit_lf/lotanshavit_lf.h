@@ -31,3 +31,4 @@ sval_t fraser_find(sl_intset_t *set, skey_t key);
 sval_t fraser_remove(sl_intset_t *set, skey_t key);
 int fraser_insert(sl_intset_t *set, skey_t key, sval_t val);
 sval_t prioritySL_deleteMin(sl_intset_t *set);
+size_t prioritySL_deleteMin_batch(sl_intset_t *set, size_t k, sval_t* out);
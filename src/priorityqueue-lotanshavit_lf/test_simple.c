@@ -57,6 +57,7 @@
 #define DS_CONTAINS(s,k,t)  pq_contains(s, k)
 #define DS_ADD(s,k,t)       pq_insert(s, k, k)
 #define DS_REMOVE(s,k,t)    pq_deleteMin(s)
+#define DS_REMOVE_BATCH(s,k,o) ((k) == 1 ? ((o)[0] = pq_deleteMin(s)) != 0 : pq_deleteMin_batch(s, k, o))
 #define DS_SIZE(s)          sl_set_size(s)
 #define DS_NEW()            sl_set_new()
 
@@ -81,6 +82,10 @@ size_t pf_vals_num = 1023;
 size_t put, put_explicit = false;
 double update_rate, put_rate, get_rate;
 
+size_t batch_k = 1;		/* elements per deleteMin */
+size_t rank_every = 0;		/* sample the rank error every n deleteMin (0: off) */
+uint64_t rank_err_sum = 0, rank_err_max = 0, rank_err_num = 0;
+
 size_t size_after = 0;
 int seed = 0;
 __thread unsigned long * seeds;
@@ -123,6 +128,20 @@ typedef struct thread_data
   DS_TYPE* set;
 } thread_data_t;
 
+/* rank error of the n values returned by one deleteMin(_batch) */
+static inline void
+rank_sample(DS_TYPE* set, sval_t* vals, size_t n, uint64_t* sum, uint64_t* max, uint64_t* num)
+{
+  size_t j;
+  for (j = 0; j < n; j++)
+    {
+      uint64_t r = pq_rank(set, vals[j]);
+      *sum += r;
+      *max = (r > *max) ? r : *max;
+      (*num)++;
+    }
+}
+
 void*
 test(void* thread) 
 {
@@ -152,6 +171,8 @@ test(void* thread)
   uint64_t my_putting_count_succ = 0;
   uint64_t my_getting_count_succ = 0;
   uint64_t my_removing_count_succ = 0;
+  uint64_t my_rank_sum = 0, my_rank_max = 0, my_rank_num = 0;
+  sval_t batch_vals[batch_k];
     
 #if defined(COMPUTE_LATENCY) && PFD_TYPE == 0
   volatile ticks start_acq, end_acq;
@@ -163,6 +184,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
     
 
@@ -207,7 +229,10 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
  
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
@@ -236,19 +261,24 @@ test(void* thread)
         }									
       else				
         {									
-          int removed;							
-          START_TS(2);							
-          removed = DS_REMOVE(set, key, algo_type);				
-          if(removed != 0)							
-	    {								
-	      END_TS(2, my_removing_count_succ);				
-	      ADD_DUR(my_removing_succ);				 	
-              my_removing_count_succ++;					
-            }								
-          END_TS_ELSE(5, my_removing_count - my_removing_count_succ, my_removing_fail);					
-          my_removing_count++;
+          size_t removed;
+          START_TS(2);
+          removed = DS_REMOVE_BATCH(set, batch_k, batch_vals);
+          if(removed != 0)
+            {
+	      END_TS(2, my_removing_count_succ);
+	      ADD_DUR(my_removing_succ);
+	      if (rank_every && ((my_removing_count / batch_k) % rank_every) == 0)
+		{
+		  rank_sample(set, batch_vals, removed, &my_rank_sum, &my_rank_max, &my_rank_num);
+		}
+              my_removing_count_succ += removed;
+            }
+          END_TS_ELSE(5, my_removing_count - my_removing_count_succ, my_removing_fail);
+          my_removing_count += batch_k;
         }
     }
+  PE_STOP();
 
   my_putting_count_succ--;
   my_removing_count_succ--;
@@ -284,11 +314,16 @@ test(void* thread)
     {
       print_latency_stats(ID, SSPFD_NUM_ENTRIES, print_vals_num);
       RETRY_STATS_SHARE();
+      rank_err_sum += my_rank_sum;
+      rank_err_num += my_rank_num;
+      rank_err_max = (my_rank_max > rank_err_max) ? my_rank_max : rank_err_max;
     }
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -314,6 +349,9 @@ main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"batch",                     required_argument, NULL, 'k'},
+    {"rank-error",                required_argument, NULL, 'R'},
+    {"stall",                     required_argument, NULL, 'S'},
     {NULL, 0, NULL, 0}
   };
 
@@ -321,7 +359,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:R:S:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -362,6 +400,12 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -k, --batch <int>\n"
+		 "        Elements claimed by each deleteMin (pq_deleteMin_batch if > 1)\n"
+		 "  -R, --rank-error <int>\n"
+		 "        Measure the rank error of every n-th deleteMin (0 = off)\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -392,6 +436,15 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'k':
+	  batch_k = atoi(optarg);
+	  break;
+	case 'R':
+	  rank_every = atoi(optarg);
+	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -413,7 +466,16 @@ main(int argc, char **argv)
       range = 2 * initial;
     }
 
+  if (batch_k == 0)
+    {
+      batch_k = 1;
+    }
+
   printf("## Initial: %zu / Range: %zu\n", initial, range);
+  if (batch_k > 1)
+    {
+      printf("## deleteMin batch: %zu elements\n", batch_k);
+    }
 
   double kb = initial * sizeof(DS_NODE) / 1024.0;
   double mb = kb / 1024.0;
@@ -604,6 +666,13 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  if (rank_every)
+    {
+      printf("#rank error (every %zu deleteMin) : avg %.2f / max %llu (%llu samples)\n", rank_every,
+	     rank_err_num ? (double) rank_err_sum / rank_err_num : 0.0, (LLU) rank_err_max, (LLU) rank_err_num);
+    }
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, size_pad_32);
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();
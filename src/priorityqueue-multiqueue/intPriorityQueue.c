@@ -0,0 +1,53 @@
+/*   
+ *   File: intPriorityQueue.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: priority queue interface of the MultiQueue
+ *   intPriorityQueue.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "intPriorityQueue.h"
+
+sval_t
+pq_contains(mqueue_t *set, skey_t key)
+{
+  return mq_find(set, key);
+}
+
+int
+pq_insert(mqueue_t *set, skey_t key, sval_t val)
+{
+  return mq_insert(set, key, val);
+}
+
+sval_t
+pq_deleteMin(mqueue_t *set)
+{
+  return mq_delete_min(set);
+}
+
+size_t
+pq_deleteMin_batch(mqueue_t *set, size_t k, sval_t* out)
+{
+  return mq_delete_min_batch(set, k, out);
+}
+
+size_t
+pq_rank(mqueue_t *set, skey_t key)
+{
+  return mq_rank(set, key);
+}
@@ -0,0 +1,299 @@
+/*   
+ *   File: multiqueue.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: MultiQueue relaxed priority queue: c*p array-based binary
+ *   heaps, each protected by an OPTIK lock
+ *   multiqueue.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "multiqueue.h"
+
+RETRY_STATS_VARS;
+
+#include "latency.h"
+#if LATENCY_PARSING == 1
+__thread size_t lat_parsing_get = 0;
+__thread size_t lat_parsing_put = 0;
+__thread size_t lat_parsing_rem = 0;
+#endif	/* LATENCY_PARSING == 1 */
+
+__thread ssmem_allocator_t* alloc;
+
+LOCK_LOCAL_DATA;
+
+mqueue_t*
+mq_new(size_t num_heaps)
+{
+  mqueue_t* mq;
+  if ((mq = (mqueue_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mqueue_t))) == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+
+  mq->num_heaps = (num_heaps > 0) ? num_heaps : 1;
+  mq->heaps = (mq_heap_t*) ssalloc_aligned(CACHE_LINE_SIZE, mq->num_heaps * sizeof(mq_heap_t));
+  if (mq->heaps == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+
+  size_t i;
+  for (i = 0; i < mq->num_heaps; i++)
+    {
+      mq_heap_t* h = &mq->heaps[i];
+      optik_init(&h->lock);
+      h->top = MQ_EMPTY;
+      h->size = 0;
+      h->capacity = MQ_INITIAL_CAPACITY;
+      h->items = (mq_item_t*) malloc(h->capacity * sizeof(mq_item_t));
+      assert(h->items != NULL);
+    }
+  return mq;
+}
+
+void
+mq_delete(mqueue_t* mq)
+{
+  size_t i;
+  for (i = 0; i < mq->num_heaps; i++)
+    {
+      free(mq->heaps[i].items);
+    }
+}
+
+size_t
+mq_size(mqueue_t* mq)
+{
+  size_t i, size = 0;
+  for (i = 0; i < mq->num_heaps; i++)
+    {
+      size += mq->heaps[i].size;
+    }
+  return size;
+}
+
+/* heap operations: the caller holds the lock of the heap */
+
+static inline void
+mq_heap_push(mq_heap_t* h, skey_t key, sval_t val)
+{
+  if (unlikely(h->size == h->capacity))
+    {
+      /* peeks never touch the items, so they can move */
+      h->capacity *= 2;
+      h->items = (mq_item_t*) realloc(h->items, h->capacity * sizeof(mq_item_t));
+      assert(h->items != NULL);
+    }
+
+  mq_item_t* items = h->items;
+  size_t i = h->size++;
+  while (i > 0 && items[(i - 1) / 2].key > key)
+    {
+      items[i] = items[(i - 1) / 2];
+      i = (i - 1) / 2;
+    }
+  items[i].key = key;
+  items[i].val = val;
+  h->top = items[0].key;
+}
+
+static inline sval_t
+mq_heap_pop(mq_heap_t* h)
+{
+  mq_item_t* items = h->items;
+  sval_t val = items[0].val;
+  mq_item_t last = items[--h->size];
+  size_t i = 0, n = h->size;
+  while (1)
+    {
+      size_t c = 2 * i + 1;
+      if (c >= n)
+	{
+	  break;
+	}
+      if (c + 1 < n && items[c + 1].key < items[c].key)
+	{
+	  c++;
+	}
+      if (last.key <= items[c].key)
+	{
+	  break;
+	}
+      items[i] = items[c];
+      i = c;
+    }
+  items[i] = last;
+  h->top = n ? items[0].key : MQ_EMPTY;
+  return val;
+}
+
+static inline mq_heap_t*
+mq_random_heap(mqueue_t* mq)
+{
+  return &mq->heaps[rand_range(mq->num_heaps) - 1];
+}
+
+static int
+mq_is_empty(mqueue_t* mq)
+{
+  size_t i;
+  for (i = 0; i < mq->num_heaps; i++)
+    {
+      if (mq->heaps[i].top != MQ_EMPTY)
+	{
+	  return 0;
+	}
+    }
+  return 1;
+}
+
+sval_t
+mq_find(mqueue_t* mq, skey_t key)
+{
+  sval_t val = 0;
+  size_t i, j;
+  for (i = 0; i < mq->num_heaps && val == 0; i++)
+    {
+      mq_heap_t* h = &mq->heaps[i];
+      optik_lock(&h->lock);
+      for (j = 0; j < h->size; j++)
+	{
+	  if (h->items[j].key == key)
+	    {
+	      val = h->items[j].val;
+	      break;
+	    }
+	}
+      optik_unlock(&h->lock);
+    }
+  return val;
+}
+
+int
+mq_insert(mqueue_t* mq, skey_t key, sval_t val)
+{
+  NUM_RETRIES();
+  while (1)
+    {
+      mq_heap_t* h = mq_random_heap(mq);
+      if (optik_trylock(&h->lock))
+	{
+	  mq_heap_push(h, key, val);
+	  optik_unlock(&h->lock);
+	  return 1;
+	}
+      DO_PAUSE();
+    }
+}
+
+/*
+ * locks the heap with the better of two peeked tops (only if it did not
+ * change since the peek); NULL if the queue is empty
+ */
+static mq_heap_t*
+mq_lock_better_of_two(mqueue_t* mq)
+{
+  NUM_RETRIES();
+  int empty = 0;
+  while (1)
+    {
+      mq_heap_t* a = mq_random_heap(mq);
+      mq_heap_t* b = mq_random_heap(mq);
+      COMPILER_NO_REORDER(optik_t va = a->lock;);
+      COMPILER_NO_REORDER(skey_t ka = a->top;);
+      COMPILER_NO_REORDER(optik_t vb = b->lock;);
+      skey_t kb = b->top;
+
+      if (kb < ka)
+	{
+	  a = b;
+	  va = vb;
+	  ka = kb;
+	}
+
+      if (unlikely(ka == MQ_EMPTY))
+	{
+	  if (++empty >= MQ_EMPTY_TRIES && mq_is_empty(mq))
+	    {
+	      return NULL;
+	    }
+	  continue;
+	}
+
+      if (optik_trylock_version(&a->lock, va))
+	{
+	  return a;
+	}
+      DO_PAUSE();
+    }
+}
+
+sval_t
+mq_delete_min(mqueue_t* mq)
+{
+  mq_heap_t* h = mq_lock_better_of_two(mq);
+  if (h == NULL)
+    {
+      return 0;
+    }
+  sval_t val = mq_heap_pop(h);
+  optik_unlock(&h->lock);
+  return val;
+}
+
+/* pops up to k elements from the better of two heaps, under a single lock */
+size_t
+mq_delete_min_batch(mqueue_t* mq, size_t k, sval_t* out)
+{
+  mq_heap_t* h = mq_lock_better_of_two(mq);
+  if (h == NULL)
+    {
+      return 0;
+    }
+  size_t n = 0;
+  while (n < k && h->size > 0)
+    {
+      out[n++] = mq_heap_pop(h);
+    }
+  optik_unlock(&h->lock);
+  return n;
+}
+
+/* the number of elements smaller than key (locks one heap at a time) */
+size_t
+mq_rank(mqueue_t* mq, skey_t key)
+{
+  size_t i, j, rank = 0;
+  for (i = 0; i < mq->num_heaps; i++)
+    {
+      mq_heap_t* h = &mq->heaps[i];
+      if (h->top >= key)
+	{
+	  continue;
+	}
+      optik_lock(&h->lock);
+      for (j = 0; j < h->size; j++)
+	{
+	  rank += (h->items[j].key < key);
+	}
+      optik_unlock(&h->lock);
+    }
+  return rank;
+}
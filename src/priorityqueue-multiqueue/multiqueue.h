@@ -0,0 +1,91 @@
+/*   
+ *   File: multiqueue.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: MultiQueue relaxed priority queue: c*p array-based binary
+ *   heaps, each protected by an OPTIK lock
+ *   multiqueue.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#ifndef _MULTIQUEUE_H_
+#define _MULTIQUEUE_H_
+
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "common.h"
+
+#include <atomic_ops.h>
+#include "lock_if.h"
+#include "ssmem.h"
+#include "optik.h"
+#include "utils.h"
+
+/*
+ * Inserts go to a random heap (trylock, else another random heap). A
+ * deleteMin peeks at the top key and the OPTIK version of two random heaps
+ * without locking, picks the one with the smaller top, and pops it only if
+ * the version is unchanged (optik_trylock_version), i.e., if the peeked top
+ * is still the top. The top key is kept next to the lock, so that a peek
+ * touches a single cache line.
+ */
+
+#define MQ_EMPTY                 KEY_MAX
+#define MQ_INITIAL_CAPACITY      64
+#define MQ_EMPTY_TRIES           8 /* empty peeks before checking all heaps */
+#define MQ_DEFAULT_HEAPS_PER_THR 2 /* c */
+
+extern __thread ssmem_allocator_t* alloc;
+
+typedef struct mq_item
+{
+  skey_t key;
+  sval_t val;
+} mq_item_t;
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct mq_heap
+{
+  optik_t lock;
+  volatile skey_t top;		/* MQ_EMPTY if empty */
+  size_t size;
+  size_t capacity;
+  mq_item_t* items;
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(optik_t) - sizeof(skey_t) - 2 * sizeof(size_t) - sizeof(mq_item_t*)];
+} mq_heap_t;
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct mqueue
+{
+  size_t num_heaps;
+  mq_heap_t* heaps;
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(size_t) - sizeof(mq_heap_t*)];
+} mqueue_t;
+
+mqueue_t* mq_new(size_t num_heaps);
+void mq_delete(mqueue_t* mq);
+size_t mq_size(mqueue_t* mq);
+
+sval_t mq_find(mqueue_t* mq, skey_t key);
+int mq_insert(mqueue_t* mq, skey_t key, sval_t val);
+sval_t mq_delete_min(mqueue_t* mq);
+size_t mq_delete_min_batch(mqueue_t* mq, size_t k, sval_t* out);
+size_t mq_rank(mqueue_t* mq, skey_t key);
+
+#endif	/* _MULTIQUEUE_H_ */
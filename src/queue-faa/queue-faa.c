@@ -0,0 +1,182 @@
+/*
+ *   File: queue-faa.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: fetch-and-add based segmented queue
+ *   queue-faa.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+/*
+ * Lock-free queue of segments (in the spirit of LCRQ and of the queue of
+ * Yang and Mellor-Crummey). Segments are arrays of QUEUE_SEG_SIZE slots,
+ * linked as in the MS queue. An enqueue claims a slot with one fetch-and-add
+ * on the enq_idx of the tail segment and CASes its value in; a dequeue claims
+ * a slot with one fetch-and-add on the deq_idx of the head segment and takes
+ * the value. If the dequeuer arrives first, it marks the slot TAKEN and the
+ * enqueuer retries with a new slot. Only the enqueue that finds the tail
+ * segment full and the dequeue that drains the head segment CAS the tail /
+ * head pointers, i.e., once per QUEUE_SEG_SIZE operations.
+ *
+ * Dequeues first check (with reads only) whether the queue is empty, so that
+ * dequeuers on an empty queue neither burn slots nor write shared lines.
+ * Drained segments are freed with ssmem and recycled for new segments.
+ *
+ * The values 0 and -1 are reserved (empty and taken slots).
+ */
+
+#include "queue-faa.h"
+#include "utils.h"
+
+RETRY_STATS_VARS;
+
+#include "latency.h"
+#if LATENCY_PARSING == 1
+__thread size_t lat_parsing_get = 0;
+__thread size_t lat_parsing_put = 0;
+__thread size_t lat_parsing_rem = 0;
+#endif	/* LATENCY_PARSING == 1 */
+
+/* a segment that the thread allocated but did not manage to link */
+static __thread queue_seg_t* queue_seg_spare = NULL;
+
+sval_t
+queue_faa_find(queue_t* qu, skey_t key)
+{
+  return 1;
+}
+
+int
+queue_faa_insert(queue_t* qu, skey_t key, sval_t val)
+{
+  queue_seg_t* seg = NULL;
+  NUM_RETRIES();
+  while (1)
+    {
+      queue_seg_t* tail = qu->tail;
+      uint64_t idx = FAI_U64(&tail->enq_idx);
+      if (likely(idx < QUEUE_SEG_SIZE))
+	{
+	  if (CAS_U64(&tail->slots[idx], QUEUE_SLOT_EMPTY, val) == QUEUE_SLOT_EMPTY)
+	    {
+	      break;
+	    }
+	  /* a dequeuer took the slot before us */
+	  continue;
+	}
+
+      /* the tail segment is full */
+      if (tail != qu->tail)
+	{
+	  continue;
+	}
+
+      queue_seg_t* next = tail->next;
+      if (next == NULL)
+	{
+	  if (seg == NULL)
+	    {
+	      /* allocate and then start over: the tail might be freed meanwhile */
+	      seg = queue_seg_spare;
+	      queue_seg_spare = NULL;
+	      if (seg == NULL)
+		{
+		  seg = queue_new_seg(val);
+		}
+	      seg->slots[0] = val;
+	      continue;
+	    }
+
+	  if (CAS_PTR(&tail->next, NULL, seg) == NULL)
+	    {
+	      UNUSED void* dummy = CAS_PTR(&qu->tail, tail, seg);
+	      return 1;
+	    }
+	}
+      else
+	{
+	  UNUSED void* dummy = CAS_PTR(&qu->tail, tail, next);
+	}
+      DO_PAUSE();
+    }
+
+  if (seg != NULL)
+    {
+      queue_seg_spare = seg;
+    }
+  return 1;
+}
+
+sval_t
+queue_faa_delete(queue_t* qu)
+{
+  NUM_RETRIES();
+  while (1)
+    {
+      queue_seg_t* head = qu->head;
+      if (head->deq_idx >= head->enq_idx && head->next == NULL)
+	{
+	  return 0;
+	}
+
+      uint64_t idx = FAI_U64(&head->deq_idx);
+      if (unlikely(idx >= QUEUE_SEG_SIZE))
+	{
+	  /* the head segment is drained */
+	  queue_seg_t* next = head->next;
+	  if (next == NULL)
+	    {
+	      return 0;
+	    }
+	  if (head == qu->tail)
+	    {
+	      /* the tail lags behind: it must not point to the freed segment */
+	      UNUSED void* dummy = CAS_PTR(&qu->tail, head, next);
+	    }
+	  if (CAS_PTR(&qu->head, head, next) == head)
+	    {
+	      queue_delete_seg(head);
+	    }
+	  continue;
+	}
+
+      sval_t val = head->slots[idx];
+      if (val == QUEUE_SLOT_EMPTY && idx < head->enq_idx)
+	{
+	  /* the enqueuer of the slot is on its way */
+	  uint32_t p;
+	  for (p = 0; p < QUEUE_FAA_PATIENCE && (val = head->slots[idx]) == QUEUE_SLOT_EMPTY; p++)
+	    {
+	      PAUSE;
+	    }
+	}
+
+      if (val == QUEUE_SLOT_EMPTY)
+	{
+	  val = (sval_t) SWAP_U64((volatile uint64_t*) &head->slots[idx], (uint64_t) QUEUE_SLOT_TAKEN);
+	  if (val == QUEUE_SLOT_EMPTY)
+	    {
+	      DO_PAUSE();
+	      continue;
+	    }
+	}
+      else
+	{
+	  head->slots[idx] = QUEUE_SLOT_TAKEN;
+	}
+      return val;
+    }
+}
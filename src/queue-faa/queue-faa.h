@@ -0,0 +1,32 @@
+/*
+ *   File: queue-faa.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: fetch-and-add based segmented queue
+ *   queue-faa.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "queue-segment.h"
+
+/* spins a dequeuer waits for the enqueuer of its slot before taking the slot */
+#ifndef QUEUE_FAA_PATIENCE
+#  define QUEUE_FAA_PATIENCE 64
+#endif
+
+sval_t queue_faa_find(queue_t *set, skey_t key);
+int queue_faa_insert(queue_t *set, skey_t key, sval_t val);
+sval_t queue_faa_delete(queue_t *set);
@@ -0,0 +1,104 @@
+/*
+ *   File: queue-segment.c
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: segments (arrays of slots) of the fetch-and-add queue
+ *   queue-segment.c is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include "queue-segment.h"
+#include "utils.h"
+
+__thread ssmem_allocator_t* alloc;
+
+queue_seg_t*
+queue_new_seg(sval_t val)
+{
+#if GC == 1
+  queue_seg_t* seg = ssmem_alloc(alloc, sizeof(*seg));
+#else
+  queue_seg_t* seg = ssalloc_aligned(CACHE_LINE_SIZE, sizeof(*seg));
+#endif
+
+  /* segments are recycled, so all the slots have to be reset */
+  memset((void*) seg->slots, 0, sizeof(seg->slots));
+  seg->slots[0] = val;
+  seg->deq_idx = 0;
+  seg->enq_idx = (val != QUEUE_SLOT_EMPTY);
+  seg->next = NULL;
+
+#ifdef __tile__
+  MEM_BARRIER;
+#endif
+
+  return seg;
+}
+
+void
+queue_delete_seg(queue_seg_t* s)
+{
+#if GC == 1
+  ssmem_free(alloc, (void*) s);
+#endif
+}
+
+queue_t*
+queue_new()
+{
+  queue_t *set;
+
+  if ((set = (queue_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(queue_t))) == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+
+  queue_seg_t* seg = (queue_seg_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(queue_seg_t));
+  if (seg == NULL)
+    {
+      perror("malloc");
+      exit(1);
+    }
+  memset(seg, 0, sizeof(queue_seg_t));
+  set->head = seg;
+  set->tail = seg;
+
+  return set;
+}
+
+void
+queue_delete(queue_t *set)
+{
+  printf("queue_delete - implement me\n");
+}
+
+int queue_size(queue_t *set)
+{
+  int size = 0;
+  queue_seg_t* seg;
+  size_t i;
+
+  for (seg = set->head; seg != NULL; seg = seg->next)
+    {
+      for (i = 0; i < QUEUE_SEG_SIZE; i++)
+	{
+	  sval_t v = seg->slots[i];
+	  size += (v != QUEUE_SLOT_EMPTY && v != QUEUE_SLOT_TAKEN);
+	}
+    }
+  return size;
+}
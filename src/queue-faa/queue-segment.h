@@ -0,0 +1,84 @@
+/*
+ *   File: queue-segment.h
+ *   Author: Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>
+ *   Description: segments (arrays of slots) of the fetch-and-add queue
+ *   queue-segment.h is part of ASCYLIB
+ *
+ * Copyright (c) 2014 Vasileios Trigonakis <vasileios.trigonakis@epfl.ch>,
+ * 	     	      Tudor David <tudor.david@epfl.ch>
+ *	      	      Distributed Programming Lab (LPD), EPFL
+ *
+ * ASCYLIB is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation, version 2
+ * of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+#include <assert.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+#include <stdint.h>
+
+#include "common.h"
+
+#include <atomic_ops.h>
+#include "lock_if.h"
+#include "ssmem.h"
+
+extern unsigned int global_seed;
+extern __thread ssmem_allocator_t* alloc;
+
+/* slots per segment */
+#ifndef QUEUE_SEG_SIZE
+#  define QUEUE_SEG_SIZE 1024
+#endif
+
+/* a slot is empty (0), holds a value, or was taken by a dequeuer */
+#define QUEUE_SLOT_EMPTY ((sval_t) 0)
+#define QUEUE_SLOT_TAKEN ((sval_t) -1)
+
+/*
+ * The indices only grow: an enqueue (dequeue) owns slot FAI(enq_idx)
+ * (FAI(deq_idx)), and indices beyond QUEUE_SEG_SIZE mean that the segment
+ * is full (drained).
+ */
+typedef struct queue_seg
+{
+  volatile uint64_t deq_idx;
+  uint8_t padding1[CACHE_LINE_SIZE - sizeof(uint64_t)];
+  volatile uint64_t enq_idx;
+  uint8_t padding2[CACHE_LINE_SIZE - sizeof(uint64_t)];
+  struct queue_seg* volatile next;
+  uint8_t padding3[CACHE_LINE_SIZE - sizeof(struct queue_seg*)];
+  volatile sval_t slots[QUEUE_SEG_SIZE];
+} queue_seg_t;
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct queue
+{
+  queue_seg_t* volatile head;
+  uint8_t padding1[CACHE_LINE_SIZE - sizeof(queue_seg_t*)];
+  queue_seg_t* volatile tail;
+  uint8_t padding2[CACHE_LINE_SIZE - sizeof(queue_seg_t*)];
+} queue_t;
+
+/*
+ * Create a new segment whose first slot holds val (or an empty segment if
+ * val is QUEUE_SLOT_EMPTY).
+ */
+queue_seg_t* queue_new_seg(sval_t val);
+void queue_delete_seg(queue_seg_t* s);
+queue_t* queue_new();
+void queue_delete(queue_t* qu);
+int queue_size(queue_t* qu);
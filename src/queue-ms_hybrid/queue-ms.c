@@ -52,6 +52,32 @@ queue_ms_insert(queue_t* qu, skey_t key, sval_t val)
 }
 
 
+/* the n nodes are linked privately and appended in one tail critical section */
+int
+queue_ms_insert_batch(queue_t* qu, skey_t* keys, sval_t* vals, size_t n)
+{
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  queue_node_t* first = queue_new_node(keys[0], vals[0], NULL);
+  queue_node_t* last = first;
+  size_t i;
+  for (i = 1; i < n; i++)
+    {
+      last->next = queue_new_node(keys[i], vals[i], NULL);
+      last = last->next;
+    }
+
+  LOCK_A(&qu->tail_lock);
+  qu->tail->next = first;
+  qu->tail = last; 
+  UNLOCK_A(&qu->tail_lock);
+  return n;
+}
+
+
 sval_t
 queue_ms_delete(queue_t* qu)
 {
@@ -59,9 +85,13 @@ queue_ms_delete(queue_t* qu)
   queue_node_t* next, *head;
   while (1)
     {
+      /* the snapshot has to be read in this order: next after tail */
       head = qu->head;
+      COMPILER_BARRIER();
       queue_node_t* tail = qu->tail;
+      COMPILER_BARRIER();
       next = head->next;
+      COMPILER_BARRIER();
       if (likely(head == qu->head))
 	{
 	  if (head == tail)
@@ -89,3 +119,60 @@ queue_ms_delete(queue_t* qu)
 #endif
   return val;
 }
+
+/* claims up to k nodes with one CAS on head; their values are stored in vals */
+size_t
+queue_ms_delete_batch(queue_t* qu, sval_t* vals, size_t k)
+{
+  NUM_RETRIES();
+  queue_node_t* head, *head_new;
+  size_t n;
+  while (1)
+    {
+      head = qu->head;
+      COMPILER_BARRIER();
+      queue_node_t* tail = qu->tail;
+      COMPILER_BARRIER();
+      head_new = head;
+      for (n = 0; n < k; n++)
+	{
+	  queue_node_t* next = head_new->next;
+	  if (next == NULL)
+	    {
+	      break;
+	    }
+	  if (head_new == tail)
+	    {
+	      /* the tail lags behind: it must not point to a claimed node */
+	      UNUSED void* dummy = CAS_PTR(&qu->tail, tail, next);
+	      tail = qu->tail;
+	    }
+	  head_new = next;
+	  vals[n] = next->val;
+	}
+
+      COMPILER_BARRIER();
+      if (likely(head == qu->head))
+	{
+	  if (n == 0)
+	    {
+	      return 0;
+	    }
+	  if (CAS_PTR(&qu->head, head, head_new) == head)
+	    {
+	      break;
+	    }
+	}
+      DO_PAUSE();
+    }
+
+#if GC == 1
+  while (head != head_new)
+    {
+      queue_node_t* next = head->next;
+      ssmem_free(alloc, (void*) head);
+      head = next;
+    }
+#endif
+  return n;
+}
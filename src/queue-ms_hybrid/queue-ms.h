@@ -25,3 +25,5 @@
 sval_t queue_ms_find(queue_t *set, skey_t key);
 int queue_ms_insert(queue_t *set, skey_t key, sval_t val);
 sval_t queue_ms_delete(queue_t *set);
+int queue_ms_insert_batch(queue_t *set, skey_t* keys, sval_t* vals, size_t n);
+size_t queue_ms_delete_batch(queue_t *set, sval_t* vals, size_t k);
@@ -40,3 +40,9 @@ queue_remove(queue_t *set)
 {
   return queue_ms_delete(set);
 }
+
+inline sval_t
+queue_remove_blocking(queue_t *set)
+{
+  return queue_ms_delete_blocking(set);
+}
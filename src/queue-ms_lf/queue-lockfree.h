@@ -37,6 +37,7 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "optik.h"
+#include "parking.h"
 
 extern unsigned int global_seed;
 extern __thread ssmem_allocator_t* alloc;
@@ -54,6 +55,8 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct queue
   uint8_t padding1[CACHE_LINE_SIZE - sizeof(queue_node_t*)];
   queue_node_t* tail;
   uint8_t padding2[CACHE_LINE_SIZE - sizeof(queue_node_t*)];
+  parking_t park;		/* consumers parked on the empty queue */
+  uint8_t padding3[CACHE_LINE_SIZE - sizeof(parking_t)];
 } queue_t;
 
 int floor_log_2(unsigned int n);
@@ -70,4 +73,5 @@ queue_node_t *queue_new_node(skey_t key, sval_t val, queue_node_t *next);
 void queue_delete_node(queue_node_t* n);
 queue_t* queue_new();
 void queue_delete(queue_t* qu);
+void queue_close(queue_t* qu);
 int queue_size(queue_t* cqu);
@@ -65,6 +65,7 @@ queue_ms_insert(queue_t* qu, skey_t key, sval_t val)
       DO_PAUSE();
     }
   UNUSED void* dummy = CAS_PTR(&qu->tail, tail, node);
+  park_wake(&qu->park);
   return 1;
 }
 
@@ -76,9 +77,13 @@ queue_ms_delete(queue_t* qu)
   queue_node_t* next, *head;
   while (1)
     {
+      /* the snapshot has to be read in this order: next after tail */
       head = qu->head;
+      COMPILER_BARRIER();
       queue_node_t* tail = qu->tail;
+      COMPILER_BARRIER();
       next = head->next;
+      COMPILER_BARRIER();
       if (likely(head == qu->head))
 	{
 	  if (head == tail)
@@ -106,3 +111,12 @@ queue_ms_delete(queue_t* qu)
 #endif
   return next->val;
 }
+
+/* as queue_ms_delete, but spins and then parks while the queue is empty */
+sval_t
+queue_ms_delete_blocking(queue_t* qu)
+{
+  sval_t val;
+  PARK_DEQUEUE(&qu->park, val, queue_ms_delete(qu), 0);
+  return val;
+}
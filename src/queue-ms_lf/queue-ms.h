@@ -25,3 +25,4 @@
 sval_t queue_ms_find(queue_t *set, skey_t key);
 int queue_ms_insert(queue_t *set, skey_t key, sval_t val);
 sval_t queue_ms_delete(queue_t *set);
+sval_t queue_ms_delete_blocking(queue_t *set);
@@ -40,3 +40,15 @@ queue_remove(queue_t *set)
 {
   return queue_optik_delete(set);
 }
+
+inline int
+queue_enqueue_batch(queue_t *set, skey_t* keys, sval_t* vals, size_t n)
+{
+  return queue_optik_insert_batch(set, keys, vals, n);
+}
+
+inline size_t
+queue_dequeue_batch(queue_t *set, sval_t* vals, size_t k)
+{
+  return queue_optik_delete_batch(set, vals, k);
+}
@@ -63,6 +63,10 @@ queue_new()
   node->next = NULL;
   set->head = node;
   set->tail = node;
+#if defined(COHORT)
+  HEAD_LOCK_INIT(&set->head_lock);
+  INIT_LOCK(&set->tail_lock);
+#endif
 
   return set;
 }
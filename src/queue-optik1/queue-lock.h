@@ -48,15 +48,42 @@ typedef struct queue_node
   struct queue_node* next;
 } queue_node_t;
 
+#if defined(COHORT)
+/* LOCK=COHORT: both locks are cohort OPTIK locks, the head one is used with versions */
+typedef optik_cohort_t head_lock_t;
+typedef optik_cohort_version_t head_version_t;
+#  define HEAD_LOCK_INIT(l)             optik_cohort_init(l)
+#  define HEAD_LOCK_VERSION(l)          optik_cohort_get_version(l)
+#  define HEAD_TRYLOCK_VERSION(l, v)    optik_cohort_trylock_version(l, v)
+#  define HEAD_UNLOCK(l)                optik_cohort_unlock(l)
+
+typedef ALIGNED(CACHE_LINE_SIZE) struct queue
+{
+  queue_node_t* head;
+  uint8_t padding1[CACHE_LINE_SIZE - sizeof(queue_node_t*)];
+  head_lock_t head_lock;
+  queue_node_t* tail;
+  uint8_t padding2[CACHE_LINE_SIZE - sizeof(queue_node_t*)];
+  ptlock_t tail_lock;
+} queue_t;
+#else
+typedef optik_t head_lock_t;
+typedef optik_t head_version_t;
+#  define HEAD_LOCK_INIT(l)             optik_init(l)
+#  define HEAD_LOCK_VERSION(l)          (*(l))
+#  define HEAD_TRYLOCK_VERSION(l, v)    optik_trylock_version(l, v)
+#  define HEAD_UNLOCK(l)                optik_unlock(l)
+
 typedef ALIGNED(CACHE_LINE_SIZE) struct queue
 {
   queue_node_t* head;
-  optik_t head_lock;
-  uint8_t padding1[CACHE_LINE_SIZE - sizeof(queue_node_t*) - sizeof(optik_t)];
+  head_lock_t head_lock;
+  uint8_t padding1[CACHE_LINE_SIZE - sizeof(queue_node_t*) - sizeof(head_lock_t)];
   queue_node_t* tail;
   ptlock_t tail_lock;
   uint8_t padding2[CACHE_LINE_SIZE - sizeof(queue_node_t*) - sizeof(ptlock_t)];
 } queue_t;
+#endif
 
 int floor_log_2(unsigned int n);
 
@@ -51,6 +51,32 @@ queue_optik_insert(queue_t* qu, skey_t key, sval_t val)
   return 1;
 }
 
+
+/* the n nodes are linked privately and appended in one tail critical section */
+int
+queue_optik_insert_batch(queue_t* qu, skey_t* keys, sval_t* vals, size_t n)
+{
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  queue_node_t* first = queue_new_node(keys[0], vals[0], NULL);
+  queue_node_t* last = first;
+  size_t i;
+  for (i = 1; i < n; i++)
+    {
+      last->next = queue_new_node(keys[i], vals[i], NULL);
+      last = last->next;
+    }
+
+  LOCK_A(&qu->tail_lock);
+  qu->tail->next = first;
+  qu->tail = last; 
+  UNLOCK_A(&qu->tail_lock);
+  return n;
+}
+
 /* int */
 /* queue_optik_insert(queue_t* qu, skey_t key, sval_t val) */
 /* { */
@@ -68,7 +94,7 @@ queue_optik_delete(queue_t* qu)
 {
   NUM_RETRIES();
  restart:
-  COMPILER_NO_REORDER(const optik_t version = qu->head_lock;);
+  COMPILER_NO_REORDER(const head_version_t version = HEAD_LOCK_VERSION(&qu->head_lock););
   const queue_node_t* node = qu->head;
   const queue_node_t* head_new = node->next;
   if (head_new == NULL)
@@ -76,14 +102,14 @@ queue_optik_delete(queue_t* qu)
       return 0;
     }
 
-  if (!optik_trylock_version(&qu->head_lock, version))
+  if (!HEAD_TRYLOCK_VERSION(&qu->head_lock, version))
     {
       DO_PAUSE();
       goto restart;
     }
 
   qu->head = (queue_node_t*) head_new;
-  optik_unlock(&qu->head_lock);
+  HEAD_UNLOCK(&qu->head_lock);
 
 #if GC == 1
   ssmem_free(alloc, (void*) node);
@@ -91,3 +117,50 @@ queue_optik_delete(queue_t* qu)
 
   return head_new->val;
 }
+
+/* claims up to k nodes with one trylock; their values are stored in vals */
+size_t
+queue_optik_delete_batch(queue_t* qu, sval_t* vals, size_t k)
+{
+  NUM_RETRIES();
+ restart:
+  COMPILER_NO_REORDER(const head_version_t version = HEAD_LOCK_VERSION(&qu->head_lock););
+  queue_node_t* node = qu->head;
+  queue_node_t* head_new = node;
+  size_t n;
+  for (n = 0; n < k; n++)
+    {
+      queue_node_t* next = head_new->next;
+      if (next == NULL)
+	{
+	  break;
+	}
+      head_new = next;
+      vals[n] = next->val;
+    }
+
+  if (n == 0)
+    {
+      return 0;
+    }
+
+  if (!HEAD_TRYLOCK_VERSION(&qu->head_lock, version))
+    {
+      DO_PAUSE();
+      goto restart;
+    }
+
+  qu->head = head_new;
+  HEAD_UNLOCK(&qu->head_lock);
+
+#if GC == 1
+  while (node != head_new)
+    {
+      queue_node_t* next = node->next;
+      ssmem_free(alloc, (void*) node);
+      node = next;
+    }
+#endif
+
+  return n;
+}
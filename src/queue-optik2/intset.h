@@ -26,3 +26,6 @@
 sval_t queue_contains(queue_t *set, skey_t key);
 int queue_add(queue_t *set, skey_t key, sval_t val);
 sval_t queue_remove(queue_t *set);
+sval_t queue_remove_blocking(queue_t *set);
+int queue_enqueue_batch(queue_t *set, skey_t* keys, sval_t* vals, size_t n);
+size_t queue_dequeue_batch(queue_t *set, sval_t* vals, size_t k);
@@ -64,6 +64,7 @@ queue_new()
   node->next = NULL;
   set->head = node;
   set->tail = node;
+  park_init(&set->park);
 
   return set;
 }
@@ -74,6 +75,13 @@ queue_delete(queue_t *set)
   printf("queue_delete - implement me\n");
 }
 
+/* wakes up the parked consumers; blocking dequeues do not park anymore */
+void
+queue_close(queue_t *set)
+{
+  park_close(&set->park);
+}
+
 int queue_size(queue_t *set)
 {
   int size = 0;
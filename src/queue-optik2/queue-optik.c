@@ -65,10 +65,58 @@ queue_optik_insert(queue_t* qu, skey_t key, sval_t val)
       DO_PAUSE();
     }
   UNUSED void* dummy = CAS_PTR(&qu->tail, tail, node);
+  park_wake(&qu->park);
   return 1;
 }
 
 
+/* the n nodes are linked privately and appended with one CAS on tail->next */
+int
+queue_optik_insert_batch(queue_t* qu, skey_t* keys, sval_t* vals, size_t n)
+{
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  queue_node_t* first = queue_new_node(keys[0], vals[0], NULL);
+  queue_node_t* last = first;
+  size_t i;
+  for (i = 1; i < n; i++)
+    {
+      last->next = queue_new_node(keys[i], vals[i], NULL);
+      last = last->next;
+    }
+
+  queue_node_t* tail;
+  NUM_RETRIES();
+  while(1)
+    {
+      tail = qu->tail;
+      queue_node_t* next = tail->next;
+      if (likely(tail == qu->tail))
+	{
+	  if (next == NULL)
+	    {
+	      if (CAS_PTR(&tail->next, NULL, first) == NULL)
+		{
+		  break;
+		}
+	    }
+	  else
+	    {
+	      UNUSED void* dummy = CAS_PTR(&qu->tail, tail, next);
+	    }
+	}
+      DO_PAUSE();
+    }
+  /* if this fails, other threads move the tail along the chain */
+  UNUSED void* dummy = CAS_PTR(&qu->tail, tail, last);
+  park_wake(&qu->park);
+  return n;
+}
+
+
 sval_t
 queue_optik_delete(queue_t* qu)
 {
@@ -97,3 +145,64 @@ queue_optik_delete(queue_t* qu)
 
   return head_new->val;
 }
+
+/* claims up to k nodes with one trylock; their values are stored in vals */
+size_t
+queue_optik_delete_batch(queue_t* qu, sval_t* vals, size_t k)
+{
+  NUM_RETRIES();
+ restart:
+  COMPILER_NO_REORDER(const optik_t version = qu->head_lock;);
+  queue_node_t* node = qu->head;
+  queue_node_t* head_new = node;
+  size_t n;
+  for (n = 0; n < k; n++)
+    {
+      queue_node_t* next = head_new->next;
+      if (next == NULL)
+	{
+	  break;
+	}
+      if (unlikely(head_new == qu->tail))
+	{
+	  /* the tail lags behind: move it past the nodes that will be freed */
+	  UNUSED void* dummy = CAS_PTR(&qu->tail, head_new, next);
+	}
+      head_new = next;
+      vals[n] = next->val;
+    }
+
+  if (n == 0)
+    {
+      return 0;
+    }
+
+  if (!optik_trylock_version(&qu->head_lock, version))
+    {
+      DO_PAUSE();
+      goto restart;
+    }
+
+  qu->head = head_new;
+  optik_unlock(&qu->head_lock);
+
+#if GC == 1
+  while (node != head_new)
+    {
+      queue_node_t* next = node->next;
+      ssmem_free(alloc, (void*) node);
+      node = next;
+    }
+#endif
+
+  return n;
+}
+
+/* as queue_optik_delete, but spins and then parks while the queue is empty */
+sval_t
+queue_optik_delete_blocking(queue_t* qu)
+{
+  sval_t val;
+  PARK_DEQUEUE(&qu->park, val, queue_optik_delete(qu), 0);
+  return val;
+}
@@ -121,6 +121,31 @@ queue_optik_insert(queue_t* qu, skey_t key, sval_t val)
   optik_unlock(&qu->tail_lock);
   return 1;
 }
+/* the n nodes are linked privately and appended in one tail critical section
+   (batches do not go through the overflow list) */
+int
+queue_optik_insert_batch(queue_t* qu, skey_t* keys, sval_t* vals, size_t n)
+{
+  if (unlikely(n == 0))
+    {
+      return 0;
+    }
+
+  queue_node_t* first = queue_new_node(keys[0], vals[0], NULL);
+  queue_node_t* last = first;
+  size_t i;
+  for (i = 1; i < n; i++)
+    {
+      last->next = queue_new_node(keys[i], vals[i], NULL);
+      last = last->next;
+    }
+
+  optik_lock_backoff(&qu->tail_lock);
+  qu->tail->next = first;
+  qu->tail = last; 
+  optik_unlock(&qu->tail_lock);
+  return n;
+}
 
 sval_t
 queue_optik_delete(queue_t* qu)
@@ -150,3 +175,50 @@ queue_optik_delete(queue_t* qu)
 
   return head_new->val;
 }
+
+/* claims up to k nodes with one trylock; their values are stored in vals */
+size_t
+queue_optik_delete_batch(queue_t* qu, sval_t* vals, size_t k)
+{
+  NUM_RETRIES();
+ restart:
+  COMPILER_NO_REORDER(const optik_t version = qu->head_lock;);
+  queue_node_t* node = qu->head;
+  queue_node_t* head_new = node;
+  size_t n;
+  for (n = 0; n < k; n++)
+    {
+      queue_node_t* next = head_new->next;
+      if (next == NULL)
+	{
+	  break;
+	}
+      head_new = next;
+      vals[n] = next->val;
+    }
+
+  if (n == 0)
+    {
+      return 0;
+    }
+
+  if (!optik_trylock_version(&qu->head_lock, version))
+    {
+      DO_PAUSE();
+      goto restart;
+    }
+
+  qu->head = head_new;
+  optik_unlock(&qu->head_lock);
+
+#if GC == 1
+  while (node != head_new)
+    {
+      queue_node_t* next = node->next;
+      ssmem_free(alloc, (void*) node);
+      node = next;
+    }
+#endif
+
+  return n;
+}
@@ -253,3 +253,228 @@ fraser_insert(sl_intset_t *set, skey_t key, sval_t val)
   return result;
 }
 
+/*
+ * like fraser_search, but with use_fingers, the parse of each level starts
+ * from left_list[i] (the predecessors of a previous, smaller key) if it is
+ * further than the node we reached from the level above
+ */
+static void
+fraser_finger_search(sl_intset_t *set, skey_t key, sl_node_t **left_list, sl_node_t **right_list, int use_fingers)
+{
+  int i;
+  sl_node_t *left, *left_next, *right, *right_next;
+
+ retry:
+  PARSE_TRY();
+
+  left = set->head;
+  for (i = levelmax - 1; i >= 0; i--)
+    {
+      if (use_fingers)
+	{
+	  sl_node_t* finger = left_list[i];
+	  if (finger->key > left->key && finger->key < key && !is_marked((uintptr_t) finger->next[i]))
+	    {
+	      left = finger;
+	    }
+	}
+
+      left_next = left->next[i];
+      if (unlikely(is_marked((uintptr_t)left_next)))
+	{
+	  use_fingers = 0;
+	  goto retry;
+	}
+      /* Find unmarked node pair at this level */
+      for (right = left_next; ; right = right_next)
+	{
+	  /* Skip a sequence of marked nodes */
+	  right_next = right->next[i];
+	  while (unlikely(is_marked((uintptr_t)right_next)))
+	    {
+	      right = (sl_node_t*)unset_mark((uintptr_t)right_next);
+	      right_next = right->next[i];
+	    }
+
+	  if (right->key >= key)
+	    {
+	      break;
+	    }
+	  left = right; 
+	  left_next = right_next;
+	}
+      /* Ensure left and right nodes are adjacent */
+      if ((left_next != right))
+	{
+	  if ((!ATOMIC_CAS_MB(&left->next[i], left_next, right)))
+	    {
+	      CLEANUP_TRY();
+	      use_fingers = 0;
+	      goto retry;
+	    }
+	}
+
+      left_list[i] = left;
+      right_list[i] = right;
+    }
+}
+
+/* links new at level i (> 0), as fraser_insert does */
+static void
+fraser_link_level(sl_intset_t *set, sl_node_t* new, int i)
+{
+  sl_node_t *preds[FRASER_MAX_MAX_LEVEL], *succs[FRASER_MAX_MAX_LEVEL];
+  sl_node_t *pred, *succ, *new_next;
+
+  while (1)
+    {
+      fraser_search(set, new->key, preds, succs);
+      pred = preds[i];
+      succ = succs[i];
+      new_next = new->next[i];
+      if (is_marked((uintptr_t) new_next))
+	{
+	  return;
+	}
+      if ((new_next != succ) && 
+	  (!ATOMIC_CAS_MB(&new->next[i], unset_mark((uintptr_t)new_next), succ)))
+	{
+	  return;
+	}
+      if (succ == new)
+	{
+	  return;
+	}
+      if (ATOMIC_CAS_MB(&pred->next[i], succ, new))
+	{
+	  return;
+	}
+    }
+}
+
+#define FRASER_RUN_MAX 32
+
+/*
+ * inserts the n keys (sorted in ascending order) and returns how many were
+ * inserted. The parse for each key starts from the predecessors of the
+ * previous key (finger search). The keys that fall between the same pair of
+ * nodes at level 0 (a run) are chained together privately and made visible
+ * with a single CAS per level; if the CAS of a level > 0 fails, the nodes of
+ * the run are linked one by one on that level. Ssmem memory is not freed
+ * until the end, so the fingers stay valid.
+ */
+size_t
+fraser_insert_sorted_batch(sl_intset_t *set, skey_t* keys, sval_t* vals, size_t n)
+{
+  sl_node_t *preds[FRASER_MAX_MAX_LEVEL], *succs[FRASER_MAX_MAX_LEVEL], *first[FRASER_MAX_MAX_LEVEL];
+  sl_node_t *run[FRASER_RUN_MAX], *spare[FRASER_RUN_MAX];
+  int nspare = 0, use_fingers = 0;
+  size_t k = 0, inserted = 0;
+  int i, j;
+
+  while (k < n)
+    {
+      UPDATE_TRY();
+      skey_t key = keys[k];
+      fraser_finger_search(set, key, preds, succs, use_fingers);
+      use_fingers = 1;
+
+      if (succs[0]->key == key)
+	{
+	  if (succs[0]->deleted)
+	    {		   /* Value is deleted: remove it and retry */
+	      mark_node_ptrs(succs[0]);
+	      continue;
+	    }
+	  k++;
+	  continue;
+	}
+
+      /* collect the run */
+      const size_t k_start = k;
+      int nrun = 0, toplevel = 0;
+      while (k < n && nrun < FRASER_RUN_MAX && keys[k] < succs[0]->key)
+	{
+	  if (nrun > 0 && keys[k] == run[nrun - 1]->key)
+	    {
+	      k++;
+	      continue;
+	    }
+	  sl_node_t* new = (nspare > 0) ? spare[--nspare] : sl_new_simple_node(keys[k], vals[k], get_rand_level(), 0);
+	  new->key = keys[k];
+	  new->val = vals[k];
+	  if (new->toplevel > toplevel)
+	    {
+	      toplevel = new->toplevel;
+	    }
+	  run[nrun++] = new;
+	  k++;
+	}
+
+      /* chain the run, from the last node to the first */
+      for (i = 0; i < toplevel; i++)
+	{
+	  first[i] = succs[i];
+	}
+      for (j = nrun - 1; j >= 0; j--)
+	{
+	  for (i = 0; i < run[j]->toplevel; i++)
+	    {
+	      run[j]->next[i] = first[i];
+	      first[i] = run[j];
+	    }
+	}
+
+#if defined(__tile__)
+      MEM_BARRIER;
+#endif
+
+      /* the run is visible once inserted at the lowest level */
+      if (!ATOMIC_CAS_MB(&preds[0]->next[0], succs[0], first[0]))
+	{
+	  for (j = 0; j < nrun; j++)
+	    {
+	      spare[nspare++] = run[j];
+	    }
+	  k = k_start;
+	  continue;
+	}
+      inserted += nrun;
+
+      for (i = 1; i < toplevel; i++)
+	{
+	  /* a node of the run that was meanwhile deleted must not be linked */
+	  int deleted = 0;
+	  for (j = 0; j < nrun; j++)
+	    {
+	      deleted |= (run[j]->toplevel > i && is_marked((uintptr_t) run[j]->next[i]));
+	    }
+
+	  if (deleted || !ATOMIC_CAS_MB(&preds[i]->next[i], succs[i], first[i]))
+	    {
+	      for (j = 0; j < nrun; j++)
+		{
+		  if (run[j]->toplevel > i)
+		    {
+		      fraser_link_level(set, run[j], i);
+		    }
+		}
+	    }
+	}
+
+      /* the last node of the run on each level is the finger for the next key */
+      for (j = 0; j < nrun; j++)
+	{
+	  for (i = 0; i < run[j]->toplevel; i++)
+	    {
+	      preds[i] = run[j];
+	    }
+	}
+    }
+
+  for (j = 0; j < nspare; j++)
+    {
+      sl_delete_node(spare[j]);
+    }
+  return inserted;
+}
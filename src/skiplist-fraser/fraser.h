@@ -30,3 +30,4 @@
 sval_t fraser_find(sl_intset_t *set, skey_t key);
 sval_t fraser_remove(sl_intset_t *set, skey_t key);
 int fraser_insert(sl_intset_t *set, skey_t key, sval_t val);
+size_t fraser_insert_sorted_batch(sl_intset_t *set, skey_t* keys, sval_t* vals, size_t n);
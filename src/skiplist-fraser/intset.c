@@ -137,4 +137,18 @@ sl_remove(sl_intset_t *set, skey_t key)
   return result;
 }
 
-
+size_t
+sl_insert_sorted_batch(sl_intset_t *set, skey_t* keys, sval_t* vals, size_t n)
+{
+  size_t result = 0;
+#ifdef SEQUENTIAL
+  size_t i;
+  for (i = 0; i < n; i++)
+    {
+      result += sl_seq_add(set, keys[i], vals[i]);
+    }
+#elif defined LOCKFREE /* fraser lock-free */
+  result = fraser_insert_sorted_batch(set, keys, vals, n);
+#endif
+  return result;
+}
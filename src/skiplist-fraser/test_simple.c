@@ -56,6 +56,7 @@
 #define DS_CONTAINS(s,k,t)  sl_contains(s, k)
 #define DS_ADD(s,k,t)       sl_add(s, k, k)
 #define DS_REMOVE(s,k,t)    sl_remove(s, k)
+#define DS_ADD_BATCH(s,k,n) sl_insert_sorted_batch(s, k, (sval_t*) k, n)
 #define DS_SIZE(s)          sl_set_size(s)
 #define DS_NEW()            sl_set_new()
 
@@ -74,6 +75,7 @@ size_t update = DEFAULT_UPDATE;
 size_t load_factor;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+size_t batch_keys = 0;		/* > 0: batch ingest mode */
 
 size_t print_vals_num = 100; 
 size_t pf_vals_num = 1023;
@@ -116,6 +118,13 @@ extern __thread uint32_t put_num_failed_on_new;
 
 barrier_t barrier, barrier_global;
 
+static int
+key_cmp(const void* a, const void* b)
+{
+  skey_t ka = *(const skey_t*) a, kb = *(const skey_t*) b;
+  return (ka > kb) - (ka < kb);
+}
+
 typedef struct thread_data
 {
   uint32_t id;
@@ -161,6 +170,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
     
 
@@ -205,14 +215,60 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
-  while (stop == 0) 
+  if (batch_keys > 0)
     {
-      TEST_LOOP(NULL);
+      /* batch ingest: each op handles batch_keys keys; inserts are sorted batches */
+      skey_t* batch = (skey_t*) malloc(batch_keys * sizeof(skey_t));
+      assert(batch != NULL);
+      size_t b;
+      while (stop == 0) 
+	{
+	  c = (uint32_t)(my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])));
+	  if (unlikely(c <= scale_put))
+	    {
+	      for (b = 0; b < batch_keys; b++)
+		{
+		  batch[b] = (my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])) & rand_max) + rand_min;
+		}
+	      qsort(batch, batch_keys, sizeof(skey_t), key_cmp);
+	      my_putting_count_succ += DS_ADD_BATCH(set, batch, batch_keys);
+	      my_putting_count += batch_keys;
+	    }
+	  else
+	    {
+	      for (b = 0; b < batch_keys; b++)
+		{
+		  key = (my_random(&(seeds[0]),&(seeds[1]),&(seeds[2])) & rand_max) + rand_min;
+		  if (unlikely(c <= scale_rem))
+		    {
+		      my_removing_count_succ += (DS_REMOVE(set, key, NULL) != 0);
+		      my_removing_count++;
+		    }
+		  else
+		    {
+		      my_getting_count_succ += (DS_CONTAINS(set, key, NULL) != 0);
+		      my_getting_count++;
+		    }
+		}
+	    }
+	}
+      free(batch);
     }
+  else
+    {
+      while (stop == 0) 
+	{
+	  TEST_LOOP(NULL);
+	}
+    }
+  PE_STOP();
 
   barrier_cross(&barrier);
   RR_STOP_SIMPLE();
@@ -249,7 +305,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -273,8 +331,10 @@ main(int argc, char **argv)
     {"range",                     required_argument, NULL, 'r'},
     {"update-rate",               required_argument, NULL, 'u'},
     {"num-buckets",               required_argument, NULL, 'b'},
+    {"batch-keys",                required_argument, NULL, 'k'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"stall",                     required_argument, NULL, 'S'},
     {NULL, 0, NULL, 0}
   };
 
@@ -282,7 +342,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:k:S:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -319,10 +379,15 @@ main(int argc, char **argv)
 		 "        Percentage of put update transactions (should be less than percentage of updates)\n"
 		 "  -b, --num-buckets <int>\n"
 		 "        Number of initial buckets (stronger than -l)\n"
+		 "  -k, --batch-keys <int>\n"
+		 "        Batch ingest: insert sorted batches of <int> keys with sl_insert_sorted_batch\n"
+		 "        (removals and searches are also done <int> keys at a time)\n"
 		 "  -v, --print-vals <int>\n"
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -347,12 +412,18 @@ main(int argc, char **argv)
 	case 'l':
 	  load_factor = atoi(optarg);
 	  break;
+	case 'k':
+	  batch_keys = atol(optarg);
+	  break;
 	case 'v':
 	  print_vals_num = atoi(optarg);
 	  break;
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -386,6 +457,11 @@ main(int argc, char **argv)
       range = range_pow2;
     }
 
+  if (batch_keys > 0)
+    {
+      printf("## Batch ingest: %zu keys per batch\n", batch_keys);
+    }
+
   if (put > update)
     {
       put = update;
@@ -565,6 +641,8 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, size_pad_32);
 
   RR_PRINT_UNPROTECTED(RAPL_PRINT_POW);
   RR_PRINT_CORRECTED();
@@ -32,11 +32,41 @@ sl_contains(sl_intset_t *set, skey_t key)
 inline int
 sl_add(sl_intset_t *set, skey_t key, sval_t val)
 {  
-  return sl_optik_insert(set, key, val);
+  int ret = sl_optik_insert(set, key, val);
+  SIZE_COUNTER_INC(set->sizes, ret);
+  return ret;
 }
 
 inline sval_t
 sl_remove(sl_intset_t *set, skey_t key)
 {
-  return sl_optik_delete(set, key);
+  sval_t ret = sl_optik_delete(set, key);
+  SIZE_COUNTER_DEC(set->sizes, ret != 0);
+  return ret;
+}
+
+inline sval_t
+sl_put(sl_intset_t *set, skey_t key, sval_t val)
+{
+  sval_t ret = sl_optik_put(set, key, val);
+  SIZE_COUNTER_INC(set->sizes, ret == 0);
+  return ret;
+}
+
+inline sval_t
+sl_replace(sl_intset_t *set, skey_t key, sval_t val)
+{
+  return sl_optik_replace(set, key, val);
+}
+
+inline int
+sl_cas_value(sl_intset_t *set, skey_t key, sval_t expected, sval_t val)
+{
+  return sl_optik_cas_value(set, key, expected, val);
+}
+
+inline size_t
+sl_range(sl_intset_t *set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max)
+{
+  return sl_optik_range(set, lo, hi, keys, vals, max);
 }
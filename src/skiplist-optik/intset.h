@@ -26,3 +26,7 @@
 sval_t sl_contains(sl_intset_t *set, skey_t key);
 int sl_add(sl_intset_t *set, skey_t key, sval_t val);
 sval_t sl_remove(sl_intset_t *set, skey_t key);
+sval_t sl_put(sl_intset_t *set, skey_t key, sval_t val);
+sval_t sl_replace(sl_intset_t *set, skey_t key, sval_t val);
+int sl_cas_value(sl_intset_t *set, skey_t key, sval_t expected, sval_t val);
+size_t sl_range(sl_intset_t *set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max);
@@ -154,7 +154,7 @@ sl_set_new()
   max = sl_new_node(KEY_MAX, 0, NULL, levelmax, 1);
   min = sl_new_node(KEY_MIN, 0, max, levelmax, 1);
   set->head = min;
-
+  set->sizes = SIZE_COUNTER_NEW();
 
   return set;
 }
@@ -174,6 +174,7 @@ sl_set_delete(sl_intset_t *set)
 #if defined(LL_GLOBAL_LOCK)
   ssfree((void*) set->lock);
 #endif
+  SIZE_COUNTER_FREE(set->sizes);
   ssfree((void*) set);
 }
 
@@ -194,3 +195,36 @@ int sl_set_size(sl_intset_t *set)
     }
   return size;
 }
+
+/* O(threads) with SIZE_COUNTERS (see size_counter.h), a traversal otherwise */
+size_t
+sl_set_size_approx(sl_intset_t* set)
+{
+#if SIZE_COUNTERS == 1
+  return size_counter_read(set->sizes);
+#else
+  return sl_set_size(set);
+#endif
+}
+
+/* bytes of all the nodes (every node takes size_pad_32 bytes) */
+size_t
+sl_set_memory(sl_intset_t *set)
+{
+  size_t nodes = 0;
+  sl_node_t *node = set->head;
+  while (node != NULL)
+    {
+      nodes++;
+      node = node->next[0];
+    }
+
+  size_t ns = size_pad_32;
+#if defined(DO_PAD)
+  if (ns & 63)
+    {
+      ns += 64 - (ns & 63);
+    }
+#endif
+  return sizeof(sl_intset_t) + nodes * ns;
+}
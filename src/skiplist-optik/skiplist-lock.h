@@ -92,7 +92,8 @@ node_set_unlinking(sl_node_t* node)
 typedef ALIGNED(CACHE_LINE_SIZE) struct sl_intset 
 {
   sl_node_t *head;
-  uint8_t padding[CACHE_LINE_SIZE - sizeof(sl_node_t*)];
+  size_counter_t* sizes;	/* with SIZE_COUNTERS */
+  uint8_t padding[CACHE_LINE_SIZE - sizeof(sl_node_t*) - sizeof(size_counter_t*)];
 } sl_intset_t;
 
 int get_rand_level();
@@ -111,3 +112,5 @@ void sl_delete_node(sl_node_t* n);
 sl_intset_t* sl_set_new();
 void sl_set_delete(sl_intset_t* set);
 int sl_set_size(sl_intset_t* cset);
+size_t sl_set_size_approx(sl_intset_t* set);
+size_t sl_set_memory(sl_intset_t* set);
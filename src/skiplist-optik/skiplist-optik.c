@@ -21,8 +21,10 @@
 
 #include "skiplist-optik.h"
 #include "utils.h"
+#include "node_cache.h"
 
 RETRY_STATS_VARS;
+NODE_CACHE_VARS_DEFINITION();
 
 #include "latency.h"
 #if LATENCY_PARSING == 1
@@ -36,11 +38,56 @@ extern ALIGNED(CACHE_LINE_SIZE) unsigned int levelmax;
 #define MAX_BACKOFF 131071
 #define OPTIK_MAX_MAX_LEVEL 64 /* covers up to 2^64 elements */
 
+#if NODE_CACHE_ENTRIES > 0
+/*
+ * returns a cached predecessor of key that is still linked, has the cached
+ * version, and is at least min_levels tall (or NULL)
+ */
+static inline sl_node_t*
+sl_optik_cache_get(skey_t key, uint32_t min_levels, optik_t* predv)
+{
+  node_cache_entry_t* e = node_cache_get(key, min_levels);
+  if (e != NULL)
+    {
+      sl_node_t* node = (sl_node_t*) e->node;
+      optik_t v = node->lock;
+      if (optik_get_version(v) == e->version && node_is_linked(node))
+	{
+	  NODE_CACHE_HIT();
+	  *predv = v;
+	  return node;
+	}
+      node_cache_drop(e);
+    }
+  return NULL;
+}
+
+/*
+ * The version is read before the state: a later delete changes the version.
+ * A node is used as a finger for keys up to its successor at its top level,
+ * so that a search from it moves (almost) only downwards.
+ */
+static inline void
+sl_optik_cache_put(sl_intset_t* set, sl_node_t* node)
+{
+  optik_t v = node->lock;
+  if (node != set->head && node_is_linked(node))
+    {
+      skey_t key_hi = node->next[node->toplevel - 1]->key + 1;
+      node_cache_put((void*) node, node->key + 1, key_hi, node->toplevel, optik_get_version(v));
+    }
+}
+#endif	/* NODE_CACHE_ENTRIES */
+
 /*
  * finds the predecessors and the successors of a key, 
+ * levels: in, the number of levels the caller needs; out, the number of 
+ * levels in preds/succs (less than the height of the list only if the search
+ * started from a cached node)
  */
 static sl_node_t*
-sl_optik_search(sl_intset_t* set, skey_t key, sl_node_t** preds, sl_node_t** succs, optik_t* predsv)
+sl_optik_search(sl_intset_t* set, skey_t key, sl_node_t** preds, sl_node_t** succs, optik_t* predsv,
+		uint32_t* levels)
 {
  restart:
   PARSE_TRY();
@@ -48,6 +95,14 @@ sl_optik_search(sl_intset_t* set, skey_t key, sl_node_t** preds, sl_node_t** suc
   sl_node_t* node_found = NULL;
   sl_node_t* pred = set->head;
   optik_t predv = set->head->lock;
+#if NODE_CACHE_ENTRIES > 0
+  sl_node_t* finger = sl_optik_cache_get(key, *levels, &predv);
+  if (finger != NULL)
+    {
+      pred = finger;
+    }
+#endif
+  *levels = pred->toplevel;
 	
   int i;
   for (i = (pred->toplevel - 1); i >= 0; i--)
@@ -79,7 +134,7 @@ sl_optik_search(sl_intset_t* set, skey_t key, sl_node_t** preds, sl_node_t** suc
   return node_found;
 }
 
-inline sl_node_t*
+static inline sl_node_t*
 sl_optik_left_search(sl_intset_t* set, skey_t key)
 {
   PARSE_TRY();
@@ -87,6 +142,14 @@ sl_optik_left_search(sl_intset_t* set, skey_t key)
   sl_node_t* pred, *curr, *nd = NULL;
 	
   pred = set->head;
+#if NODE_CACHE_ENTRIES > 0
+  optik_t predv;
+  sl_node_t* finger = sl_optik_cache_get(key, 1, &predv);
+  if (finger != NULL)
+    {
+      pred = finger;
+    }
+#endif
 	
   for (i = (pred->toplevel - 1); i >= 0; i--)
     {
@@ -104,6 +167,9 @@ sl_optik_left_search(sl_intset_t* set, skey_t key)
 	}
     }
 
+#if NODE_CACHE_ENTRIES > 0
+  sl_optik_cache_put(set, pred);
+#endif
   return nd;
 }
 
@@ -155,8 +221,12 @@ unlock_levels_up(sl_node_t** nodes, int low, int high)
 
 #define PAUSE_AND_RETRY() OPTIK_PAUSE(); goto restart;
 
-int
-sl_optik_insert(sl_intset_t* set, skey_t key, sval_t val)
+/*
+ * inserts key, or, if val_old is not NULL and key is in the set, writes val
+ * to the node of key and the previous value to val_old (put)
+ */
+static inline int
+sl_optik_insert_put(sl_intset_t* set, skey_t key, sval_t val, sval_t* val_old)
 {
   sl_node_t* preds[OPTIK_MAX_MAX_LEVEL], *succs[OPTIK_MAX_MAX_LEVEL];
   optik_t predsv[OPTIK_MAX_MAX_LEVEL];
@@ -169,9 +239,24 @@ sl_optik_insert(sl_intset_t* set, skey_t key, sval_t val)
   NUM_RETRIES();
  restart:
   UPDATE_TRY();
-  sl_node_t* node_found = sl_optik_search(set, key, preds, succs, predsv);
+  uint32_t levels = toplevel;
+  sl_node_t* node_found = sl_optik_search(set, key, preds, succs, predsv, &levels);
   if (node_found != NULL && !inserted_upto)
     {
+      if (val_old != NULL)
+	{
+	  optik_lock(&node_found->lock);
+	  if (unlikely(node_is_unlinking(node_found)))
+	    {
+	      /* insert after the delete is done */
+	      optik_unlock(&node_found->lock);
+	      PAUSE_AND_RETRY();
+	    }
+	  *val_old = node_found->val;
+	  node_found->val = val;
+	  optik_unlock(&node_found->lock);
+	}
+
       if (unlikely(node_new != NULL))
 	{
 #if GC == 1
@@ -211,10 +296,106 @@ sl_optik_insert(sl_intset_t* set, skey_t key, sval_t val)
   node_set_valid(node_new);
   unlock_levels_down(preds, inserted_upto, toplevel - 1);
 
+#if NODE_CACHE_ENTRIES > 0
+  sl_optik_cache_put(set, preds[0]);
+  sl_optik_cache_put(set, node_new);
+#endif
   return 1;
 }
 
 
+int
+sl_optik_insert(sl_intset_t* set, skey_t key, sval_t val)
+{
+  return sl_optik_insert_put(set, key, val, NULL);
+}
+
+sval_t
+sl_optik_put(sl_intset_t* set, skey_t key, sval_t val)
+{
+  sval_t val_old = 0;
+  sl_optik_insert_put(set, key, val, &val_old);
+  return val_old;
+}
+
+/*
+ * writes val to the node of key if its value is expected (or if expected is
+ * 0), returns the previous value (0 if key is not in the set). A node that is
+ * still linking is already in the set; a node that is unlinking is not.
+ */
+static inline sval_t
+sl_optik_update(sl_intset_t* set, skey_t key, sval_t val, sval_t expected)
+{
+  UPDATE_TRY();
+  sl_node_t* nd = sl_optik_left_search(set, key);
+  if (nd == NULL)
+    {
+      return 0;
+    }
+
+  optik_lock(&nd->lock);
+  if (unlikely(node_is_unlinking(nd)))
+    {
+      optik_unlock(&nd->lock);
+      return 0;
+    }
+
+  sval_t val_old = nd->val;
+  if (expected == 0 || val_old == expected)
+    {
+      nd->val = val;
+    }
+  optik_unlock(&nd->lock);
+  return val_old;
+}
+
+sval_t
+sl_optik_replace(sl_intset_t* set, skey_t key, sval_t val)
+{
+  return sl_optik_update(set, key, val, 0);
+}
+
+int
+sl_optik_cas_value(sl_intset_t* set, skey_t key, sval_t expected, sval_t val)
+{
+  return (expected != 0 && sl_optik_update(set, key, val, expected) == expected);
+}
+
+/*
+ * copies the keys and values of the (at most max) nodes in [lo, hi], in
+ * order, returns their number. Weakly consistent: a scan is not atomic, but
+ * every reported node was in the set at some point during the scan.
+ */
+size_t
+sl_optik_range(sl_intset_t* set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max)
+{
+  int i;
+  sl_node_t* pred = set->head, *curr;
+  for (i = (pred->toplevel - 1); i >= 0; i--)
+    {
+      curr = pred->next[i];
+      while (lo > curr->key)
+	{
+	  pred = curr;
+	  curr = pred->next[i];
+	}
+    }
+
+  size_t n = 0;
+  curr = pred->next[0];
+  while (n < max && curr->key <= hi && curr->next[0] != NULL)
+    {
+      if (!node_is_unlinking(curr))
+	{
+	  keys[n] = curr->key;
+	  vals[n] = curr->val;
+	  n++;
+	}
+      curr = curr->next[0];
+    }
+  return n;
+}
+
 sval_t
 sl_optik_delete(sl_intset_t* set, skey_t key)
 {
@@ -222,15 +403,24 @@ sl_optik_delete(sl_intset_t* set, skey_t key)
   optik_t predsv[OPTIK_MAX_MAX_LEVEL];
   int my_delete = 0;
 
+  uint32_t levels = 1;
+
   NUM_RETRIES();
  restart:
   UPDATE_TRY();
-  sl_node_t* node_found = sl_optik_search(set, key, preds, succs, predsv);
+  sl_node_t* node_found = sl_optik_search(set, key, preds, succs, predsv, &levels);
   if (node_found == NULL)
     {
       return 0;
     }
 
+  if (unlikely(node_found->toplevel > levels))
+    {
+      /* the search started from a cached node lower than node_found */
+      levels = node_found->toplevel;
+      goto restart;
+    }
+
   if (!my_delete)
     {
       if (node_is_unlinking(node_found))
@@ -284,5 +474,8 @@ sl_optik_delete(sl_intset_t* set, skey_t key)
   ssmem_free(alloc, (void*) node_found);
 #endif
 
+#if NODE_CACHE_ENTRIES > 0
+  sl_optik_cache_put(set, preds[0]);
+#endif
   return val;
 }
@@ -24,3 +24,10 @@
 sval_t sl_optik_find(sl_intset_t *set, skey_t key);
 int sl_optik_insert(sl_intset_t *set, skey_t key, sval_t val);
 sval_t sl_optik_delete(sl_intset_t *set, skey_t key);
+/* in-place updates: put returns the previous value (0 if it inserted), replace
+   the previous value (0 if key is not in the set), cas_value 1 on success */
+sval_t sl_optik_put(sl_intset_t *set, skey_t key, sval_t val);
+sval_t sl_optik_replace(sl_intset_t *set, skey_t key, sval_t val);
+int sl_optik_cas_value(sl_intset_t *set, skey_t key, sval_t expected, sval_t val);
+/* the (at most max) keys in [lo, hi], in order (weakly consistent) */
+size_t sl_optik_range(sl_intset_t *set, skey_t lo, skey_t hi, skey_t* keys, sval_t* vals, size_t max);
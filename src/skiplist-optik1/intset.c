@@ -40,3 +40,9 @@ sl_remove(sl_intset_t *set, skey_t key)
 {
   return sl_optik_delete(set, key);
 }
+
+inline size_t
+sl_insert_sorted_batch(sl_intset_t *set, skey_t* keys, sval_t* vals, size_t n)
+{
+  return sl_optik_insert_sorted_batch(set, keys, vals, n);
+}
@@ -26,3 +26,4 @@
 sval_t sl_contains(sl_intset_t *set, skey_t key);
 int sl_add(sl_intset_t *set, skey_t key, sval_t val);
 sval_t sl_remove(sl_intset_t *set, skey_t key);
+size_t sl_insert_sorted_batch(sl_intset_t *set, skey_t* keys, sval_t* vals, size_t n);
@@ -238,6 +238,186 @@ sl_optik_insert(sl_intset_t* set, skey_t key, sval_t val)
 }
 
 
+/*
+ * like sl_optik_search, but with use_fingers, the parse of each level starts
+ * from preds[i] (the predecessors of a previous, smaller key) if it is further
+ * than the node we reached from the level above
+ */
+static sl_node_t*
+sl_optik_finger_search(sl_intset_t* set, skey_t key, sl_node_t** preds, optik_t* predsv, int use_fingers)
+{
+ restart:
+  PARSE_TRY();
+	
+  sl_node_t* node_found = NULL;
+  sl_node_t* pred = set->head;
+  optik_t predv = set->head->lock;
+	
+  int i;
+  for (i = (pred->toplevel - 1); i >= 0; i--)
+    {
+      if (use_fingers)
+	{
+	  sl_node_t* finger = preds[i];
+	  if (finger->key > pred->key && finger->key < key)
+	    {
+	      optik_t fingerv = finger->lock;
+	      if (unlikely(optik_is_deleted(fingerv)))
+		{
+		  use_fingers = 0;
+		  goto restart;
+		}
+	      pred = finger;
+	      predv = fingerv;
+	    }
+	}
+
+      sl_node_t* curr = pred->next[i];
+      optik_t currv = curr->lock; 
+
+      while (key > curr->key)
+	{
+	  predv = currv;
+	  pred = curr;
+
+	  curr = pred->next[i];
+	  currv = curr->lock;  
+	}
+
+      if (unlikely(optik_is_deleted(predv)))
+      	{
+	  use_fingers = 0;
+      	  goto restart;
+      	}
+      preds[i] = pred;
+      predsv[i] = predv;
+      if (key == curr->key)
+	{
+	  node_found = curr;
+	}
+    }
+  return node_found;
+}
+
+#define SL_OPTIK_RUN_MAX 32
+
+/*
+ * inserts the n keys (sorted in ascending order) and returns how many were
+ * inserted. The parse for each key starts from the predecessors of the
+ * previous key (finger search). After locking the predecessors of a key, the
+ * following keys that fit between the same predecessors and the nodes that
+ * were just inserted (a run) are linked without unlocking: the new nodes are
+ * locked before they are linked and everything is unlocked at the end of the
+ * run. Ssmem memory is not freed until the end, so the fingers stay valid.
+ */
+size_t
+sl_optik_insert_sorted_batch(sl_intset_t* set, skey_t* keys, sval_t* vals, size_t n)
+{
+  sl_node_t* preds[OPTIK_MAX_MAX_LEVEL], *locked[OPTIK_MAX_MAX_LEVEL];
+  optik_t predsv[OPTIK_MAX_MAX_LEVEL];
+  sl_node_t* run[SL_OPTIK_RUN_MAX];
+  sl_node_t* node_new = NULL;
+  int use_fingers = 0;
+  size_t k = 0, inserted = 0;
+
+  while (k < n)
+    {
+      skey_t key = keys[k];
+    restart:
+      UPDATE_TRY();
+      sl_node_t* node_found = sl_optik_finger_search(set, key, preds, predsv, use_fingers);
+      use_fingers = 1;
+      if (node_found != NULL)
+	{
+	  if (!optik_is_deleted(node_found->lock))
+	    {
+	      k++;
+	      continue;
+	    }
+	  goto restart;	/* wait for the deleted node to be physically removed */
+	}
+
+      if (node_new == NULL)
+	{
+	  node_new = sl_new_simple_node(key, vals[k], get_rand_level(), 0);
+	}
+      node_new->key = key;
+      node_new->val = vals[k];
+      const int toplevel = node_new->toplevel;
+
+      sl_node_t* pred_prev = NULL;
+      int i;
+      for (i = 0; i < toplevel; i++)
+	{
+	  sl_node_t* pred = preds[i];
+	  if (pred_prev != pred && !optik_trylock_version(&pred->lock, predsv[i]))
+	    {
+	      unlock_levels_down(preds, 0, i - 1);
+	      goto restart;
+	    }
+	  locked[i] = pred;
+	  pred_prev = pred;
+	}
+
+      int nrun = 0;
+      const int locked_levels = toplevel;
+      while (1)
+	{
+	  optik_lock(&node_new->lock);
+	  for (i = 0; i < node_new->toplevel; i++)
+	    {
+	      node_new->next[i] = preds[i]->next[i];
+	      preds[i]->next[i] = node_new;
+	      preds[i] = node_new;
+	    }
+	  run[nrun++] = node_new;
+	  node_new = NULL;
+	  inserted++;
+	  k++;
+
+	  /* the next key extends the run if it fits before the (locked) successors */
+	  if (k == n || nrun == SL_OPTIK_RUN_MAX)
+	    {
+	      break;
+	    }
+	  key = keys[k];
+	  if (key == preds[0]->key || key == preds[0]->next[0]->key)
+	    {
+	      break;
+	    }
+
+	  node_new = sl_new_simple_node(key, vals[k], get_rand_level(), 0);
+	  if (node_new->toplevel > locked_levels)
+	    {
+	      break;
+	    }
+	  for (i = 0; i < node_new->toplevel && preds[i]->next[i]->key > key; i++);
+	  if (i < node_new->toplevel)
+	    {
+	      break;
+	    }
+	}
+
+      for (i = 0; i < nrun; i++)
+	{
+	  run[i]->state = 1;
+	  optik_unlock(&run[i]->lock);
+	}
+      unlock_levels_down(locked, 0, locked_levels - 1);
+    }
+
+  if (node_new != NULL)
+    {
+#if GC == 1
+      ssmem_free(alloc, (void*) node_new);
+#else
+      ssfree(node_new);
+#endif
+    }
+  return inserted;
+}
+
+
 sval_t
 sl_optik_delete(sl_intset_t* set, skey_t key)
 {
@@ -24,3 +24,4 @@
 sval_t sl_optik_find(sl_intset_t *set, skey_t key);
 int sl_optik_insert(sl_intset_t *set, skey_t key, sval_t val);
 sval_t sl_optik_delete(sl_intset_t *set, skey_t key);
+size_t sl_optik_insert_sorted_batch(sl_intset_t* set, skey_t* keys, sval_t* vals, size_t n);
@@ -35,6 +35,7 @@
 
 #include "ssalloc.h"
 #include "measurements.h"
+#include "huge_pages.h"
 
 #define SSMEM_CACHE_LINE_SIZE 64
 
@@ -61,7 +62,15 @@ ssalloc_init()
   int i;
   for (i = 0; i < SSALLOC_NUM_ALLOCATORS; i++)
     {
-      ssalloc_app_mem[i] = (uintptr_t) memalign(SSMEM_CACHE_LINE_SIZE, SSALLOC_SIZE);
+      if (hp_mode() != HP_NONE)
+	{
+	  size_t size = SSALLOC_SIZE;
+	  ssalloc_app_mem[i] = (uintptr_t) hp_map(&size);
+	}
+      else
+	{
+	  ssalloc_app_mem[i] = (uintptr_t) memalign(SSMEM_CACHE_LINE_SIZE, SSALLOC_SIZE);
+	}
       assert((void*) ssalloc_app_mem[i] != NULL);
     }
 #endif
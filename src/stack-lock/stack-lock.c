@@ -62,6 +62,7 @@ mstack_new()
   /* mstack_node_t* node = (mstack_node_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mstack_node_t)); */
   /* node->next = NULL; */
   set->top = NULL;
+  INIT_LOCK_A(&(set->lock));
 
   return set;
 }
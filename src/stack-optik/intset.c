@@ -40,3 +40,9 @@ mstack_remove(mstack_t *set)
 {
   return mstack_optik_delete(set);
 }
+
+inline sval_t
+mstack_remove_blocking(mstack_t *set)
+{
+  return mstack_optik_delete_blocking(set);
+}
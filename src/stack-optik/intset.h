@@ -26,3 +26,4 @@
 sval_t mstack_contains(mstack_t *set, skey_t key);
 int mstack_add(mstack_t *set, skey_t key, sval_t val);
 sval_t mstack_remove(mstack_t *set);
+sval_t mstack_remove_blocking(mstack_t *set);
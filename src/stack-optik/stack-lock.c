@@ -62,6 +62,7 @@ mstack_new()
   /* mstack_node_t* node = (mstack_node_t*) ssalloc_aligned(CACHE_LINE_SIZE, sizeof(mstack_node_t)); */
   /* node->next = NULL; */
   set->top = NULL;
+  park_init(&set->park);
 
   return set;
 }
@@ -72,6 +73,13 @@ mstack_delete(mstack_t *set)
   printf("mstack_delete - implement me\n");
 }
 
+/* wakes up the parked consumers; blocking pops do not park anymore */
+void
+mstack_close(mstack_t *set)
+{
+  park_close(&set->park);
+}
+
 int mstack_size(mstack_t *set)
 {
   int size = 0;
@@ -37,6 +37,7 @@
 #include "lock_if.h"
 #include "ssmem.h"
 #include "optik.h"
+#include "parking.h"
 
 extern unsigned int global_seed;
 extern __thread ssmem_allocator_t* alloc;
@@ -54,6 +55,8 @@ typedef ALIGNED(CACHE_LINE_SIZE) struct mstack
   mstack_node_t* top;
   optik_t lock;
   uint8_t padding2[CACHE_LINE_SIZE - sizeof(optik_t) - sizeof(mstack_node_t*)];
+  parking_t park;		/* consumers parked on the empty stack */
+  uint8_t padding3[CACHE_LINE_SIZE - sizeof(parking_t)];
 } mstack_t;
 
 int floor_log_2(unsigned int n);
@@ -70,4 +73,5 @@ mstack_node_t *mstack_new_node(skey_t key, sval_t val, mstack_node_t *next);
 void mstack_delete_node(mstack_node_t* n);
 mstack_t* mstack_new();
 void mstack_delete(mstack_t* qu);
+void mstack_close(mstack_t* qu);
 int mstack_size(mstack_t* cqu);
@@ -59,6 +59,7 @@ mstack_optik_insert(mstack_t* qu, skey_t key, sval_t val)
 
       DO_PAUSE();
     }
+  park_wake(&qu->park);
   return 1;
 }
 
@@ -93,3 +94,17 @@ mstack_optik_delete(mstack_t* qu)
 #endif
   return top->val;
 }
+
+/*
+ * as mstack_optik_delete, but spins and then parks while the stack is empty.
+ * The push is published with plain stores, so a consumer does not park while
+ * the lock is held: the pusher might have checked for waiters before the
+ * consumer registered.
+ */
+sval_t
+mstack_optik_delete_blocking(mstack_t* qu)
+{
+  sval_t val;
+  PARK_DEQUEUE(&qu->park, val, mstack_optik_delete(qu), optik_is_locked(qu->lock));
+  return val;
+}
@@ -25,3 +25,4 @@
 sval_t mstack_optik_find(mstack_t *set, skey_t key);
 int mstack_optik_insert(mstack_t *set, skey_t key, sval_t val);
 sval_t mstack_optik_delete(mstack_t *set);
+sval_t mstack_optik_delete_blocking(mstack_t *set);
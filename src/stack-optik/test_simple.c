@@ -48,6 +48,7 @@
 #endif
 
 #include "intset.h"
+#include "handoff.h"
 
 /* ################################################################### *
  * Definition of macros: per data structure
@@ -56,6 +57,9 @@
 #define DS_CONTAINS(s,k,t)  mstack_contains(s, k)
 #define DS_ADD(s,k,t)       mstack_add(s, k, t)
 #define DS_REMOVE(s)        mstack_remove(s)
+#define DS_REMOVE_BLOCKING(s) mstack_remove_blocking(s)
+#define DS_CLOSE(s)         mstack_close(s)
+#define DS_PARKS(s)         ((s)->park.parks)
 #define DS_SIZE(s)          mstack_size(s)
 #define DS_NEW()            mstack_new()
 
@@ -74,6 +78,9 @@ size_t update = 100;
 size_t load_factor;
 size_t num_threads = DEFAULT_NB_THREADS; 
 size_t duration = DEFAULT_DURATION;
+size_t consumers = 0;		/* > 0: handoff mode (see handoff.h) */
+size_t handoff_gap_us = 100;
+int handoff_spin = 0;
 
 size_t print_vals_num = 100; 
 size_t pf_vals_num = 1023;
@@ -115,6 +122,7 @@ extern __thread uint32_t put_num_failed_on_new;
 #endif
 
 barrier_t barrier, barrier_global;
+HANDOFF_VARS_DEFINITION();
 
 typedef struct thread_data
 {
@@ -161,6 +169,7 @@ test(void* thread)
   alloc = (ssmem_allocator_t*) malloc(sizeof(ssmem_allocator_t));
   assert(alloc != NULL);
   ssmem_alloc_init_fs_size(alloc, SSMEM_DEFAULT_MEM_SIZE, SSMEM_GC_FREE_SET_SIZE, ID);
+  HP_SSMEM_ARENA(alloc);
 #endif
     
 
@@ -205,14 +214,25 @@ test(void* thread)
 
   RETRY_STATS_ZERO();
 
+  PE_INIT();
   barrier_cross(&barrier_global);
+  GC_STALL(ID, num_threads);
+  PE_START();
 
   RR_START_SIMPLE();
 
-  while (stop == 0) 
+  if (consumers > 0)
     {
-      TEST_LOOP_ONLY_UPDATES();
+      HANDOFF_LOOP(ID, DS_ADD(set, __ts, __ts), DS_REMOVE(set), DS_REMOVE_BLOCKING(set));
     }
+  else
+    {
+      while (stop == 0) 
+	{
+	  TEST_LOOP_ONLY_UPDATES();
+	}
+    }
+  PE_STOP();
 
 
   barrier_cross(&barrier);
@@ -252,7 +272,9 @@ test(void* thread)
   EXEC_IN_DEC_ID_ORDER_END(&barrier);
 
   SSPFDTERM();
+  PE_TERM();
 #if GC == 1
+  MEM_STATS_COLLECT(alloc, ID);
   ssmem_term();
   free(alloc);
 #endif
@@ -265,6 +287,7 @@ OPTIK_STATS_VARS_DEFINITION();
 int
 main(int argc, char **argv) 
 {
+  BACKOFF_INIT();
   set_cpu(0);
   ssalloc_init();
   seeds = seed_rand();
@@ -280,6 +303,10 @@ main(int argc, char **argv)
     {"num-buckets",               required_argument, NULL, 'b'},
     {"print-vals",                required_argument, NULL, 'v'},
     {"vals-pf",                   required_argument, NULL, 'f'},
+    {"consumers",                 required_argument, NULL, 'c'},
+    {"gap",                       required_argument, NULL, 'g'},
+    {"spin",                      no_argument,       NULL, 'w'},
+    {"stall",                     required_argument, NULL, 'S'},
     {NULL, 0, NULL, 0}
   };
 
@@ -287,7 +314,7 @@ main(int argc, char **argv)
   while(1) 
     {
       i = 0;
-      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:", long_options, &i);
+      c = getopt_long(argc, argv, "hAf:d:i:n:r:s:u:m:a:l:p:b:v:f:c:g:wS:", long_options, &i);
 		
       if(c == -1)
 	break;
@@ -328,6 +355,14 @@ main(int argc, char **argv)
 		 "        When using detailed profiling, how many values to print.\n"
 		 "  -f, --val-pf <int>\n"
 		 "        When using detailed profiling, how many values to keep track of.\n"
+		 "  -c, --consumers <int>\n"
+		 "        Handoff mode: the last <int> threads only dequeue (blocking), the others only enqueue\n"
+		 "  -g, --gap <int>\n"
+		 "        Handoff mode: a producer enqueues one element every <int> us (default=100)\n"
+		 "  -w, --spin\n"
+		 "        Handoff mode: consumers spin on the non-blocking dequeue instead of parking\n"
+		 "  -S, --stall <int>\n"
+		 "        Stall the last thread for <int> ms at the start of the test (blocks memory reclamation)\n"
 		 , argv[0]);
 	  exit(0);
 	case 'd':
@@ -358,6 +393,18 @@ main(int argc, char **argv)
 	case 'f':
 	  pf_vals_num = pow2roundup(atoi(optarg)) - 1;
 	  break;
+	case 'c':
+	  consumers = atol(optarg);
+	  break;
+	case 'g':
+	  handoff_gap_us = atol(optarg);
+	  break;
+	case 'w':
+	  handoff_spin = 1;
+	  break;
+	case 'S':
+	  gc_stall_ms = atol(optarg);
+	  break;
 	case '?':
 	default:
 	  printf("Use -h or --help for help\n");
@@ -392,6 +439,12 @@ main(int argc, char **argv)
       range = range_pow2;
     }
 
+  if (consumers >= num_threads)
+    {
+      consumers = num_threads - 1;
+      printf("** handoff mode needs a producer: %zu consumers\n", consumers);
+    }
+
   if (put > update)
     {
       put = update;
@@ -457,6 +510,8 @@ main(int argc, char **argv)
     
   thread_data_t* tds = (thread_data_t*) malloc(num_threads * sizeof(thread_data_t));
 
+  __handoff_t0 = getticks();
+
   long t;
   for(t = 0; t < num_threads; t++)
     {
@@ -479,6 +534,10 @@ main(int argc, char **argv)
   nanosleep(&timeout, NULL);
 
   stop = 1;
+  if (consumers > 0)
+    {
+      DS_CLOSE(set);
+    }
   gettimeofday(&end, NULL);
   duration = (end.tv_sec * 1000 + end.tv_usec / 1000) - (start.tv_sec * 1000 + start.tv_usec / 1000);
     
@@ -562,6 +621,12 @@ main(int argc, char **argv)
   double throughput = (putting_count_total + getting_count_total + removing_count_total) * 1000.0 / duration;
   printf("#txs %zu\t(%-10.0f\n", num_threads, throughput);
   printf("#Mops %.3f\n", throughput / 1e6);
+  PE_PRINT(putting_count_total + getting_count_total + removing_count_total);
+  MEM_STATS_PRINT(0, size_after, sizeof(DS_NODE));
+  if (consumers > 0)
+    {
+      handoff_print(num_threads - consumers, consumers, handoff_gap_us, handoff_spin, DS_PARKS(set));
+    }
 
   OPTIK_STATS_PRINT();
 